@@ -0,0 +1,70 @@
+// Copyright 2023 Vincent Jacques
+
+#include "allocation-counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+namespace {
+
+// Off by default, so that the threads of other modes never write to these shared atomics
+std::atomic<bool> enabled(false);
+std::atomic<unsigned long> count(0);  // NOLINT(runtime/int)
+
+}  // namespace
+
+void enable_heap_allocations_count() {
+  enabled.store(true, std::memory_order_relaxed);
+}
+
+unsigned long heap_allocations_count() {  // NOLINT(runtime/int)
+  return count.load(std::memory_order_relaxed);
+}
+
+// The other forms of 'new' and 'delete' (arrays, nothrow) call these ones by default.
+// They are not inlined: GCC would then see 'malloc' and 'free' in callers, and could remove allocations that are
+// freed right away (so they wouldn't be counted), or warn that 'free' is mismatched with a 'new' expression.
+__attribute__((noinline)) void* operator new(const std::size_t size) {
+  if (enabled.load(std::memory_order_relaxed)) {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+  while (true) {
+    // 'malloc(0)' may return a null pointer, but 'operator new' must not
+    void* const p = std::malloc(size == 0 ? 1 : size);
+    if (p != nullptr) {
+      return p;
+    }
+    // As required from a replacement 'operator new': let the new-handler free some memory, and try again
+    const std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+__attribute__((noinline)) void operator delete(void* const p) noexcept {
+  std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* const p, std::size_t) noexcept {
+  std::free(p);
+}
+
+
+// LCOV_EXCL_START
+
+TEST_CASE("allocation counter") {
+  enable_heap_allocations_count();
+  const auto before = heap_allocations_count();
+  // Called explicitly: the compiler may remove the allocations of 'new' expressions that are freed right away
+  ::operator delete(::operator new(sizeof(int)));
+  ::operator delete[](::operator new[](1000 * sizeof(int)));
+  CHECK(heap_allocations_count() == before + 2);
+}
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,14 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef BENCHMARK_ALLOCATION_COUNTER_HPP_
+#define BENCHMARK_ALLOCATION_COUNTER_HPP_
+
+
+// Starts counting the calls to the global 'operator new' (and 'new[]'), in all threads.
+// This program replaces the global 'operator new' to count them, but only 'benchmark' pays for counting.
+void enable_heap_allocations_count();
+
+// Number of calls to the global 'operator new' (and 'new[]') since counting was enabled
+unsigned long heap_allocations_count();  // NOLINT(runtime/int)
+
+#endif  // BENCHMARK_ALLOCATION_COUNTER_HPP_
@@ -0,0 +1,347 @@
+// Copyright 2023 Vincent Jacques
+
+#include "sudoku-solver.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <chrones.hpp>
+
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+namespace {
+
+// The exact cover matrix of a Sudoku of this size: one row for each possible choice of a value in a cell,
+// and one column for each constraint. Each choice satisfies exactly four constraints: its cell has a value,
+// and its row, its column, and its square each have its value.
+struct Matrix {
+  struct Node {
+    uint32_t left;
+    uint32_t right;
+    uint32_t up;
+    uint32_t down;
+    uint32_t header;
+  };
+
+  static constexpr unsigned root = 0;
+
+  const unsigned size;
+  const unsigned choices_count;
+  const unsigned constraints_count;
+  // Node 0 is the root, nodes 1 to 'constraints_count' are the headers of the constraints,
+  // then each choice has four consecutive nodes, one for each constraint it satisfies
+  const unsigned first_choice_node;
+  const unsigned nodes_count;
+
+  std::vector<Node> nodes;
+  // Number of choices still satisfying each uncovered constraint, indexed by header node
+  std::vector<uint32_t> counts;
+
+  unsigned choice_index(const unsigned row, const unsigned col, const unsigned value) const {
+    return (row * size + col) * size + value;
+  }
+
+  unsigned choice_of_node(const unsigned node) const {
+    assert(node >= first_choice_node);
+    return (node - first_choice_node) / 4;
+  }
+
+  explicit Matrix(const unsigned size_) :
+    size(size_),
+    choices_count(size_ * size_ * size_),
+    constraints_count(4 * size_ * size_),
+    first_choice_node(constraints_count + 1),
+    nodes_count(first_choice_node + 4 * choices_count),
+    nodes(nodes_count),
+    counts(first_choice_node)
+  {
+    for (unsigned header = 0; header != first_choice_node; ++header) {
+      nodes[header] = {
+        header == 0 ? constraints_count : header - 1,
+        header == constraints_count ? 0 : header + 1,
+        header,
+        header,
+        header,
+      };
+      counts[header] = 0;
+    }
+
+    const auto& regions_of = RuntimeSudokuConstants::get(size).regions_of;
+    for (unsigned row = 0; row != size; ++row) {
+      for (unsigned col = 0; col != size; ++col) {
+        const unsigned square = regions_of[row * size + col][2] - 2 * size;
+        for (unsigned value = 0; value != size; ++value) {
+          const unsigned first_node = first_choice_node + 4 * choice_index(row, col, value);
+          const std::array<unsigned, 4> headers{
+            1 + row * size + col,
+            1 + size * size + row * size + value,
+            1 + 2 * size * size + col * size + value,
+            1 + 3 * size * size + square * size + value,
+          };
+          for (unsigned i = 0; i != 4; ++i) {
+            const unsigned node = first_node + i;
+            const unsigned header = headers[i];
+            // Append at the bottom of the column
+            nodes[node] = {
+              first_node + (i + 3) % 4,
+              first_node + (i + 1) % 4,
+              nodes[header].up,
+              header,
+              header,
+            };
+            nodes[nodes[header].up].down = node;
+            nodes[header].up = node;
+            ++counts[header];
+          }
+        }
+      }
+    }
+  }
+};
+
+class Solver {
+ public:
+  explicit Solver(const Matrix& matrix_) :
+    matrix(matrix_),
+    nodes(matrix_.nodes),
+    counts(matrix_.counts),
+    chosen(matrix_.size * matrix_.size),
+    chosen_count(0)
+  {}
+
+ public:
+  // Back to the full matrix, without allocating: the working copy already has the right sizes
+  void reset() {
+    nodes.assign(matrix.nodes.begin(), matrix.nodes.end());
+    counts.assign(matrix.counts.begin(), matrix.counts.end());
+    chosen_count = 0;
+  }
+
+  // Returns false if this choice contradicts previous ones
+  bool choose(const unsigned row, const unsigned col, const unsigned value) {
+    const unsigned first_node = matrix.first_choice_node + 4 * matrix.choice_index(row, col, value);
+    for (unsigned node = first_node; node != first_node + 4; ++node) {
+      if (is_covered(nodes[node].header)) {
+        return false;
+      }
+    }
+    for (unsigned node = first_node; node != first_node + 4; ++node) {
+      cover(nodes[node].header);
+    }
+    return true;
+  }
+
+  bool search() {
+    if (nodes[Matrix::root].right == Matrix::root) {
+      return true;
+    }
+
+    // The constraint satisfied by the fewest choices, to keep the search tree narrow
+    unsigned header = nodes[Matrix::root].right;
+    for (
+      unsigned other = nodes[header].right;
+      other != Matrix::root && counts[header] > 1;
+      other = nodes[other].right
+    ) {
+      if (counts[other] < counts[header]) {
+        header = other;
+      }
+    }
+    if (counts[header] == 0) {
+      return false;
+    }
+
+    cover(header);
+    for (unsigned node = nodes[header].down; node != header; node = nodes[node].down) {
+      chosen[chosen_count++] = matrix.choice_of_node(node);
+      for (unsigned other = nodes[node].right; other != node; other = nodes[other].right) {
+        cover(nodes[other].header);
+      }
+      if (search()) {
+        return true;
+      }
+      for (unsigned other = nodes[node].left; other != node; other = nodes[other].left) {
+        uncover(nodes[other].header);
+      }
+      --chosen_count;
+    }
+    uncover(header);
+    return false;
+  }
+
+  // The choices made by 'search', when it succeeded
+  const uint32_t* begin() const { return chosen.data(); }
+  const uint32_t* end() const { return chosen.data() + chosen_count; }
+
+ private:
+  bool is_covered(const unsigned header) const {
+    return nodes[nodes[header].left].right != header;
+  }
+
+  // Remove the constraint, and all choices that satisfy it from the other constraints they satisfy
+  void cover(const unsigned header) {
+    nodes[nodes[header].right].left = nodes[header].left;
+    nodes[nodes[header].left].right = nodes[header].right;
+    for (unsigned row_node = nodes[header].down; row_node != header; row_node = nodes[row_node].down) {
+      for (unsigned node = nodes[row_node].right; node != row_node; node = nodes[node].right) {
+        nodes[nodes[node].down].up = nodes[node].up;
+        nodes[nodes[node].up].down = nodes[node].down;
+        --counts[nodes[node].header];
+      }
+    }
+  }
+
+  // Exactly undo 'cover', in reverse order: removed nodes still know their neighbours
+  void uncover(const unsigned header) {
+    for (unsigned row_node = nodes[header].up; row_node != header; row_node = nodes[row_node].up) {
+      for (unsigned node = nodes[row_node].left; node != row_node; node = nodes[node].left) {
+        ++counts[nodes[node].header];
+        nodes[nodes[node].down].up = node;
+        nodes[nodes[node].up].down = node;
+      }
+    }
+    nodes[nodes[header].right].left = header;
+    nodes[nodes[header].left].right = header;
+  }
+
+ private:
+  const Matrix& matrix;
+  std::vector<Matrix::Node> nodes;
+  std::vector<uint32_t> counts;
+  // At most one choice for each cell
+  std::vector<uint32_t> chosen;
+  unsigned chosen_count;
+};
+
+// The full matrix of a size, and a working copy reset for each Sudoku
+struct Workspace {
+  explicit Workspace(const unsigned size) : matrix(size), solver(matrix) {}
+
+  const Matrix matrix;
+  Solver solver;
+};
+
+// Built on first use for each size in each thread, so that threads share no lock and no data
+Solver& reset_solver(const unsigned size) {
+  CHRONE();
+
+  thread_local std::map<unsigned, std::unique_ptr<Workspace>> workspaces;
+  auto& workspace = workspaces[size];
+  if (workspace) {
+    workspace->solver.reset();
+  } else {
+    workspace = std::make_unique<Workspace>(size);
+  }
+  return workspace->solver;
+}
+
+}  // namespace
+
+
+std::optional<RuntimeSudoku> solve_using_dlx(RuntimeSudoku sudoku) {
+  CHRONE();
+
+  const unsigned size = sudoku.size();
+
+  Solver& solver = reset_solver(size);
+
+  {
+    CHRONE("circumstantial constraints");
+    for (unsigned row = 0; row != size; ++row) {
+      for (unsigned col = 0; col != size; ++col) {
+        const auto value = sudoku.get({row, col});
+        if (value && !solver.choose(row, col, *value)) {
+          return std::nullopt;
+        }
+      }
+    }
+  }
+
+  bool solved = false;
+  {
+    CHRONE("search");
+    solved = solver.search();
+  }
+
+  if (solved) {
+    for (const unsigned choice : solver) {
+      sudoku.set({choice / size / size, choice / size % size}, choice % size);
+    }
+    return sudoku;
+  } else {
+    return std::nullopt;
+  }
+}
+
+
+// LCOV_EXCL_START
+
+template<unsigned size>
+Sudoku<ValueCell, size> make_sudoku(const std::array<std::array<unsigned, size>, size>& values) {
+  Sudoku<ValueCell, size> sudoku;
+  for (const auto& [row, col] : SudokuConstants<size>::cells) {
+    // 0 for an unset cell
+    if (values[row][col]) {
+      sudoku.cell({row, col}).set(values[row][col] - 1);
+    }
+  }
+  return sudoku;
+}
+
+TEST_CASE("dlx - empty") {
+  const auto solved = solve_using_dlx(Sudoku<ValueCell, 4>());
+  CHECK(solved);
+  for (const auto& region : SudokuConstants<4>::regions) {
+    unsigned seen = 0;
+    for (const auto& cell : region) {
+      CHECK(solved->cell(cell).get());
+      seen |= 1 << *solved->cell(cell).get();
+    }
+    CHECK(seen == 0b1111);
+  }
+}
+
+TEST_CASE("dlx - unique solution") {
+  const auto solved = solve_using_dlx(make_sudoku<4>({{
+    {1, 0, 0, 0},
+    {3, 0, 0, 2},
+    {0, 1, 0, 0},
+    {4, 0, 0, 0},
+  }}));
+  const std::array<std::array<unsigned, 4>, 4> expected{{
+    {1, 2, 3, 4},
+    {3, 4, 1, 2},
+    {2, 1, 4, 3},
+    {4, 3, 2, 1},
+  }};
+  CHECK(solved);
+  for (const auto& [row, col] : SudokuConstants<4>::cells) {
+    CHECK(solved->cell({row, col}).get() == expected[row][col] - 1);
+  }
+}
+
+TEST_CASE("dlx - unsolvable") {
+  CHECK(!solve_using_dlx(make_sudoku<4>({{
+    {1, 0, 0, 4},
+    {0, 0, 2, 0},
+    {0, 2, 0, 0},
+    {3, 0, 0, 1},
+  }})));
+}
+
+TEST_CASE("dlx - contradictory givens") {
+  CHECK(!solve_using_dlx(make_sudoku<4>({{
+    {1, 0, 0, 1},
+    {0, 0, 0, 0},
+    {0, 0, 0, 0},
+    {0, 0, 0, 0},
+  }})));
+}
+
+// LCOV_EXCL_STOP
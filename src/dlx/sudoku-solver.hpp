@@ -0,0 +1,21 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef DLX_SUDOKU_SOLVER_HPP_
+#define DLX_SUDOKU_SOLVER_HPP_
+
+#include <optional>
+
+#include "../puzzle/runtime-sudoku.hpp"
+#include "../puzzle/sudoku.hpp"
+
+
+// Solves the Sudoku as an exact cover problem, using Knuth's Algorithm X with Dancing Links.
+// Its matrix is built at runtime anyway, so it's compiled once for all sizes.
+std::optional<RuntimeSudoku> solve_using_dlx(RuntimeSudoku);
+
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> solve_using_dlx(const Sudoku<ValueCell, size>& sudoku) {
+  return to_sudoku<size>(solve_using_dlx(RuntimeSudoku(sudoku)));
+}
+
+#endif  // DLX_SUDOKU_SOLVER_HPP_
@@ -72,12 +72,38 @@ void Explanation<size>::Builder::operator()(const PropagationIsDoneForCell<size>
 template<unsigned size>
 void Explanation<size>::Builder::operator()(const PropagationIsDoneForSudoku<size>&) {}
 
+// 'explain' explores with the default options, which enable no deduction rules, so these events never reach the builder
+
+template<unsigned size>
+void Explanation<size>::Builder::operator()(const NakedPairIsFound<size>&) {}
+
+template<unsigned size>
+void Explanation<size>::Builder::operator()(const HiddenPairIsFound<size>&) {}
+
+template<unsigned size>
+void Explanation<size>::Builder::operator()(const PointingPairIsFound<size>&) {}
+
+template<unsigned size>
+void Explanation<size>::Builder::operator()(const BoxLineReductionIsFound<size>&) {}
+
+template<unsigned size>
+void Explanation<size>::Builder::operator()(const XWingIsFound<size>&) {}
+
+template<unsigned size>
+void Explanation<size>::Builder::operator()(const ValueIsForbiddenInCell<size>&) {}
+
 template<unsigned size>
 void Explanation<size>::Builder::operator()(const ExplorationStarts<size>& event) {
   assert(!stack.empty());
   assert(stack.back().exploration != nullptr);
   assert(!stack.back().exploration->has_value());
-  stack.back().exploration->emplace(Exploration{event.cell, event.allowed_values, {}});
+  std::vector<unsigned> allowed_values;
+  for (const unsigned value : SudokuConstants<size>::values) {
+    if (event.allowed_values & ExplorableSudoku<size>::bit(value)) {
+      allowed_values.push_back(value);
+    }
+  }
+  stack.back().exploration->emplace(Exploration{event.cell, allowed_values, {}});
 }
 
 template<unsigned size>
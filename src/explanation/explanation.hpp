@@ -114,6 +114,12 @@ struct Explanation {
     void operator()(const CellIsDeducedAsSinglePlaceForValueInRegion<size>&);
     void operator()(const PropagationIsDoneForCell<size>&);
     void operator()(const PropagationIsDoneForSudoku<size>&);
+    void operator()(const NakedPairIsFound<size>&);
+    void operator()(const HiddenPairIsFound<size>&);
+    void operator()(const PointingPairIsFound<size>&);
+    void operator()(const BoxLineReductionIsFound<size>&);
+    void operator()(const XWingIsFound<size>&);
+    void operator()(const ValueIsForbiddenInCell<size>&);
     void operator()(const ExplorationStarts<size>&);
     void operator()(const HypothesisIsMade<size>&);
     void operator()(const HypothesisIsRejected<size>&);
@@ -0,0 +1,271 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_DEDUCTION_RULES_HPP_
+#define EXPLORATION_DEDUCTION_RULES_HPP_
+
+#include <bit>
+#include <optional>
+#include <utility>
+
+#include "../puzzle/sudoku-constants.hpp"
+#include "events.hpp"
+#include "explorable-sudoku.hpp"
+#include "fixed-capacity-vector.hpp"
+
+
+// Deductions that look at several cells or regions at once. They are tried, in this order, when propagation
+// alone can't go further, to avoid making hypotheses. They only forbid values: the solver then applies
+// the single-value and single-place deductions that follow.
+struct DeductionRules {
+  bool naked_pairs = false;
+  bool hidden_pairs = false;
+  bool pointing_pairs = false;
+  bool box_line_reductions = false;
+  bool x_wings = false;
+};
+
+// The values to forbid, and where. Each rule forbids at most two values in each of 'size' cells.
+template<unsigned max_size>
+using Eliminations = FixedCapacityVector<std::pair<Coordinates, unsigned>, 2 * max_size>;
+
+template<typename Constants, template<unsigned> typename Event>
+struct Deduction {
+  Event<Constants::max_size> event;
+  Eliminations<Constants::max_size> eliminations;
+};
+
+// Each 'find_...' function returns the first deduction of its kind that forbids at least one value
+
+template<typename Constants>
+void add_elimination(
+  const BasicExplorableSudoku<Constants>& sudoku,
+  const Coordinates& coords,
+  const unsigned value,
+  Eliminations<Constants::max_size>* eliminations
+) {
+  if (!sudoku.is_set(coords) && sudoku.is_allowed(coords, value)) {
+    eliminations->push_back({coords, value});
+  }
+}
+
+template<typename Constants>
+std::optional<Deduction<Constants, NakedPairIsFound>> find_naked_pair(const BasicExplorableSudoku<Constants>& sudoku) {
+  const auto& constants = sudoku.get_constants();
+  const unsigned size = constants.size;
+
+  for (const unsigned region : constants.region_indexes()) {
+    const auto& cells = constants.region(region);
+    for (unsigned i = 0; i != size; ++i) {
+      if (sudoku.is_set(cells[i]) || sudoku.allowed_count(cells[i]) != 2) {
+        continue;
+      }
+      const auto values = sudoku.allowed(cells[i]);
+      for (unsigned j = i + 1; j != size; ++j) {
+        if (sudoku.allowed(cells[j]) != values) {
+          continue;
+        }
+        Deduction<Constants, NakedPairIsFound> deduction{{region, {cells[i], cells[j]}, values}, {}};
+        for (unsigned k = 0; k != size; ++k) {
+          if (k != i && k != j) {
+            for (auto remaining = values; remaining; remaining &= remaining - 1) {
+              add_elimination(sudoku, cells[k], std::countr_zero(remaining), &deduction.eliminations);
+            }
+          }
+        }
+        if (!deduction.eliminations.empty()) {
+          return deduction;
+        }
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+template<typename Constants>
+std::optional<Deduction<Constants, HiddenPairIsFound>> find_hidden_pair(
+  const BasicExplorableSudoku<Constants>& sudoku
+) {
+  typedef typename Constants::Mask Mask;
+  const auto& constants = sudoku.get_constants();
+
+  for (const unsigned region : constants.region_indexes()) {
+    const Mask unset_values = constants.all_values & ~sudoku.values_in_region(region);
+    for (Mask first_values = unset_values; first_values; first_values &= first_values - 1) {
+      const unsigned value1 = std::countr_zero(first_values);
+      const Mask places = sudoku.places_in_region(region, value1);
+      if (std::popcount(places) != 2) {
+        continue;
+      }
+      for (Mask second_values = first_values & (first_values - 1); second_values; second_values &= second_values - 1) {
+        const unsigned value2 = std::countr_zero(second_values);
+        if (sudoku.places_in_region(region, value2) != places) {
+          continue;
+        }
+        const Mask values = sudoku.bit(value1) | sudoku.bit(value2);
+        const auto& cell1 = constants.region(region)[std::countr_zero(places)];
+        const auto& cell2 = constants.region(region)[std::bit_width(places) - 1];
+        Deduction<Constants, HiddenPairIsFound> deduction{{region, {cell1, cell2}, values}, {}};
+        for (const auto& cell : {cell1, cell2}) {
+          for (Mask others = sudoku.allowed(cell) & ~values; others; others &= others - 1) {
+            add_elimination(sudoku, cell, std::countr_zero(others), &deduction.eliminations);
+          }
+        }
+        if (!deduction.eliminations.empty()) {
+          return deduction;
+        }
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+// The chunk (as returned by 'chunk_of') containing all 'positions', or 'std::nullopt' if they span several chunks
+template<typename Mask, typename ChunkOf>
+std::optional<unsigned> common_chunk(Mask positions, const ChunkOf& chunk_of) {
+  const unsigned chunk = chunk_of(std::countr_zero(positions));
+  for (; positions; positions &= positions - 1) {
+    if (chunk_of(std::countr_zero(positions)) != chunk) {
+      return std::nullopt;
+    }
+  }
+  return chunk;
+}
+
+template<typename Constants>
+std::optional<Deduction<Constants, PointingPairIsFound>> find_pointing_pair(
+  const BasicExplorableSudoku<Constants>& sudoku
+) {
+  typedef typename Constants::Mask Mask;
+  const auto& constants = sudoku.get_constants();
+  const unsigned size = constants.size;
+  const unsigned sqrt_size = constants.sqrt_size;
+
+  for (const unsigned square : constants.values()) {
+    const unsigned region = 2 * size + square;
+    const unsigned top_row = square / sqrt_size * sqrt_size;
+    const unsigned left_col = square % sqrt_size * sqrt_size;
+    const Mask unset_values = constants.all_values & ~sudoku.values_in_region(region);
+    for (Mask values = unset_values; values; values &= values - 1) {
+      const unsigned value = std::countr_zero(values);
+      const Mask places = sudoku.places_in_region(region, value);
+      // A single place is a single-place deduction
+      if (std::popcount(places) < 2) {
+        continue;
+      }
+
+      const auto row_in_square = common_chunk(places, [=](unsigned position) { return position / sqrt_size; });
+      if (row_in_square) {
+        const unsigned row = top_row + *row_in_square;
+        Deduction<Constants, PointingPairIsFound> deduction{{region, row, value}, {}};
+        for (const unsigned col : constants.values()) {
+          if (col / sqrt_size * sqrt_size != left_col) {
+            add_elimination(sudoku, {row, col}, value, &deduction.eliminations);
+          }
+        }
+        if (!deduction.eliminations.empty()) {
+          return deduction;
+        }
+      }
+
+      const auto col_in_square = common_chunk(places, [=](unsigned position) { return position % sqrt_size; });
+      if (col_in_square) {
+        const unsigned col = left_col + *col_in_square;
+        Deduction<Constants, PointingPairIsFound> deduction{{region, size + col, value}, {}};
+        for (const unsigned row : constants.values()) {
+          if (row / sqrt_size * sqrt_size != top_row) {
+            add_elimination(sudoku, {row, col}, value, &deduction.eliminations);
+          }
+        }
+        if (!deduction.eliminations.empty()) {
+          return deduction;
+        }
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+template<typename Constants>
+std::optional<Deduction<Constants, BoxLineReductionIsFound>> find_box_line_reduction(
+  const BasicExplorableSudoku<Constants>& sudoku
+) {
+  typedef typename Constants::Mask Mask;
+  const auto& constants = sudoku.get_constants();
+  const unsigned size = constants.size;
+  const unsigned sqrt_size = constants.sqrt_size;
+
+  // Rows, then columns
+  for (unsigned line = 0; line != 2 * size; ++line) {
+    const Mask unset_values = constants.all_values & ~sudoku.values_in_region(line);
+    for (Mask values = unset_values; values; values &= values - 1) {
+      const unsigned value = std::countr_zero(values);
+      const Mask places = sudoku.places_in_region(line, value);
+      if (std::popcount(places) < 2) {
+        continue;
+      }
+
+      const auto chunk = common_chunk(places, [=](unsigned position) { return position / sqrt_size; });
+      if (!chunk) {
+        continue;
+      }
+      const bool is_row = line < size;
+      const unsigned index = is_row ? line : line - size;
+      const unsigned square = is_row
+        ? index / sqrt_size * sqrt_size + *chunk
+        : *chunk * sqrt_size + index / sqrt_size;
+      Deduction<Constants, BoxLineReductionIsFound> deduction{{line, 2 * size + square, value}, {}};
+      for (const auto& [row, col] : constants.region(2 * size + square)) {
+        if ((is_row ? row : col) != index) {
+          add_elimination(sudoku, {row, col}, value, &deduction.eliminations);
+        }
+      }
+      if (!deduction.eliminations.empty()) {
+        return deduction;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+template<typename Constants>
+std::optional<Deduction<Constants, XWingIsFound>> find_x_wing(const BasicExplorableSudoku<Constants>& sudoku) {
+  typedef typename Constants::Mask Mask;
+  const auto& constants = sudoku.get_constants();
+  const unsigned size = constants.size;
+
+  for (const unsigned value : constants.values()) {
+    // Base lines are rows (and cover lines are columns), then the opposite
+    for (const unsigned base : {0u, size}) {
+      const unsigned cover = size - base;
+      for (unsigned line1 = 0; line1 != size; ++line1) {
+        const Mask places = sudoku.places_in_region(base + line1, value);
+        if (std::popcount(places) != 2) {
+          continue;
+        }
+        for (unsigned line2 = line1 + 1; line2 != size; ++line2) {
+          if (sudoku.places_in_region(base + line2, value) != places) {
+            continue;
+          }
+          const unsigned cover1 = std::countr_zero(places);
+          const unsigned cover2 = std::bit_width(places) - 1;
+          Deduction<Constants, XWingIsFound> deduction{
+            {{base + line1, base + line2}, {cover + cover1, cover + cover2}, value}, {}};
+          for (const unsigned cover_line : {cover1, cover2}) {
+            for (const unsigned line : constants.values()) {
+              if (line != line1 && line != line2) {
+                const Coordinates coords = base == 0 ? Coordinates(line, cover_line) : Coordinates(cover_line, line);
+                add_elimination(sudoku, coords, value, &deduction.eliminations);
+              }
+            }
+          }
+          if (!deduction.eliminations.empty()) {
+            return deduction;
+          }
+        }
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+#endif  // EXPLORATION_DEDUCTION_RULES_HPP_
@@ -3,9 +3,11 @@
 #ifndef EXPLORATION_EVENTS_HPP_
 #define EXPLORATION_EVENTS_HPP_
 
-#include <vector>
+#include <type_traits>
+#include <utility>
 
 #include "../puzzle/sudoku.hpp"
+#include "explorable-sudoku.hpp"
 
 
 // Name events like affirmative sentences in present tense
@@ -57,10 +59,60 @@ struct PropagationIsDoneForCell {
 template<unsigned size>
 struct PropagationIsDoneForSudoku {};
 
+// Deductions made by the rules in 'deduction-rules.hpp', when propagation alone can't go further.
+// Each one is followed by the 'ValueIsForbiddenInCell' events it implies.
+
+// The two cells of the region each allow only the two values (in 'values'),
+// so no other cell of the region can take them
+template<unsigned size>
+struct NakedPairIsFound {
+  unsigned region;
+  std::pair<Coordinates, Coordinates> cells;
+  ValuesMask<size> values;
+};
+
+// The two values (in 'values') can only be placed in the same two cells of the region
+template<unsigned size>
+struct HiddenPairIsFound {
+  unsigned region;
+  std::pair<Coordinates, Coordinates> cells;
+  ValuesMask<size> values;
+};
+
+// In the square, the value can only be placed in cells of the line (row or column)
+template<unsigned size>
+struct PointingPairIsFound {
+  unsigned square;
+  unsigned line;
+  unsigned value;
+};
+
+// In the line (row or column), the value can only be placed in cells of the square
+template<unsigned size>
+struct BoxLineReductionIsFound {
+  unsigned line;
+  unsigned square;
+  unsigned value;
+};
+
+// In each of the two base lines, the value can only be placed in cells of the two cover lines
+template<unsigned size>
+struct XWingIsFound {
+  std::pair<unsigned, unsigned> base_lines;
+  std::pair<unsigned, unsigned> cover_lines;
+  unsigned value;
+};
+
+template<unsigned size>
+struct ValueIsForbiddenInCell {
+  Coordinates cell;
+  unsigned value;
+};
+
 template<unsigned size>
 struct ExplorationStarts {
   Coordinates cell;
-  std::vector<unsigned> allowed_values;
+  ValuesMask<size> allowed_values;
 };
 
 template<unsigned size>
@@ -89,4 +141,13 @@ struct ExplorationIsDone {
   Coordinates cell;
 };
 
+// An event sink that ignores all events. Solvers detect it at compile time, and don't even construct events for it.
+struct NullEventSink {
+  template<typename Event>
+  void operator()(const Event&) const {}
+};
+
+template<typename EventSink>
+constexpr bool is_null_event_sink = std::is_same_v<std::remove_const_t<EventSink>, NullEventSink>;
+
 #endif  // EXPLORATION_EVENTS_HPP_
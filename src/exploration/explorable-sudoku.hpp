@@ -0,0 +1,281 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_EXPLORABLE_SUDOKU_HPP_
+#define EXPLORATION_EXPLORABLE_SUDOKU_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#include "../puzzle/sudoku-constants.hpp"
+#include "exploration-constants.hpp"
+#include "propagation-kernel.hpp"
+
+
+// The state of a Sudoku during exploration, stored densely (structure of arrays, no pointers)
+// so that it's cheap to copy when making a hypothesis.
+// Alternatively, changes can be recorded on a trail, to be undone when a hypothesis is rejected.
+template<typename Constants>
+class BasicExplorableSudoku {
+ public:
+  typedef typename Constants::Mask Mask;
+
+  struct Change {
+    unsigned index;
+    Mask previously_allowed;
+    bool is_set;
+  };
+  static constexpr unsigned max_size = Constants::max_size;
+  // Along a chain of hypotheses, each cell is set at most once and each of its values is forbidden at most once
+  typedef typename Constants::template Vector<Change, max_size * max_size * max_size> Trail;
+
+  static constexpr Mask bit(const unsigned value) {
+    assert(value < max_size);
+    return Mask(1) << value;
+  }
+
+  // Size of the Sudoku's state, wherever it's stored
+  static constexpr unsigned footprint(const unsigned size) {
+    return sizeof(Mask) * (4 * size * size + 4 * size + 1) + sizeof(uint16_t) * (size + 1);
+  }
+
+ public:
+  explicit BasicExplorableSudoku(const Constants& constants_ = Constants()) :
+    constants(constants_),
+    allowed_values(make_array<Mask, max_size * max_size + 1>(size() * size() + 1, constants.all_values)),
+    set_in_rows(make_array<Mask, max_size>(size(), 0)),
+    region_values(make_array<Mask, 3 * max_size>(3 * size(), 0)),
+    places(make_array<Mask, 3 * max_size * max_size>(3 * size() * size(), constants.all_values)),
+    unset_cells_by_allowed_count(make_array<uint16_t, max_size + 1>(size() + 1, 0)),
+    set_count(0),
+    trail(nullptr)
+  {  // NOLINT(whitespace/braces)
+    unset_cells_by_allowed_count[size()] = size() * size();
+  }
+
+  // Copies of the same size don't allocate, even with runtime constants
+  BasicExplorableSudoku(const BasicExplorableSudoku&) = default;
+  BasicExplorableSudoku& operator=(const BasicExplorableSudoku&) = default;
+  BasicExplorableSudoku(BasicExplorableSudoku&&) = default;
+  BasicExplorableSudoku& operator=(BasicExplorableSudoku&&) = default;
+
+ public:
+  const Constants& get_constants() const { return constants; }
+
+  unsigned size() const { return constants.size; }
+
+  // Back to the state of a new Sudoku, without changing its size
+  void reset() {
+    std::fill(allowed_values.begin(), allowed_values.end(), constants.all_values);
+    std::fill(set_in_rows.begin(), set_in_rows.end(), 0);
+    std::fill(region_values.begin(), region_values.end(), 0);
+    std::fill(places.begin(), places.end(), constants.all_values);
+    std::fill(unset_cells_by_allowed_count.begin(), unset_cells_by_allowed_count.end(), 0);
+    unset_cells_by_allowed_count[size()] = size() * size();
+    set_count = 0;
+    trail = nullptr;
+  }
+
+ public:
+  bool is_set(const Coordinates& coords) const {
+    const auto [row, col] = coords;
+    assert(row < size());
+    assert(col < size());
+    return set_in_rows[row] & bit(col);
+  }
+
+  unsigned get(const Coordinates& coords) const {
+    assert(is_set(coords));
+    return std::countr_zero(allowed(coords));
+  }
+
+  Mask allowed(const Coordinates& coords) const {
+    return allowed_values[index(coords)];
+  }
+
+  bool is_allowed(const Coordinates& coords, const unsigned value) const {
+    return allowed(coords) & bit(value);
+  }
+
+  unsigned allowed_count(const Coordinates& coords) const {
+    return std::popcount(allowed(coords));
+  }
+
+  unsigned get_single_allowed_value(const Coordinates& coords) const {
+    assert(allowed_count(coords) == 1);
+    return std::countr_zero(allowed(coords));
+  }
+
+  // The peers of a cell that allow a value, be they set or not
+  auto peers_allowing(const Coordinates& coords, const unsigned value, const PropagationKernel kernel) const {
+    return constants.peers_allowing(kernel, allowed_values.data(), index(coords), bit(value));
+  }
+
+  // Values already set in a region
+  Mask values_in_region(const unsigned region) const {
+    assert(region < 3 * size());
+    return region_values[region];
+  }
+
+  // Positions in a region (as in 'constants.region(region)') of the cells that allow a value
+  Mask places_in_region(const unsigned region, const unsigned value) const {
+    assert(region < 3 * size());
+    assert(value < size());
+    return places[region * size() + value];
+  }
+
+  // Number of cells not set yet that allow exactly 'count' values
+  unsigned unset_cells_with_allowed_count(const unsigned count) const {
+    assert(count <= size());
+    return unset_cells_by_allowed_count[count];
+  }
+
+  // Returns the values that were allowed before, except 'value'
+  Mask set(const Coordinates& coords, const unsigned value) {
+    assert(is_allowed(coords, value));
+    assert(!is_set(coords));
+
+    Mask& allowed = allowed_values[index(coords)];
+    if (trail) {
+      trail->push_back({index(coords), allowed, true});
+    }
+    const Mask previously_allowed = allowed & ~bit(value);
+    --unset_cells_by_allowed_count[std::popcount(allowed)];
+    allowed = bit(value);
+
+    const auto [row, col] = coords;
+    set_in_rows[row] |= bit(col);
+    for (const unsigned region : constants.regions_of(coords)) {
+      region_values[region] |= bit(value);
+    }
+    update_places(coords, previously_allowed, false);
+    ++set_count;
+
+    return previously_allowed;
+  }
+
+  void forbid(const Coordinates& coords, const unsigned value) {
+    assert(is_allowed(coords, value));
+    assert(!is_set(coords));
+    // At least one value is always allowed
+    assert(allowed_count(coords) > 1);
+
+    Mask& allowed = allowed_values[index(coords)];
+    if (trail) {
+      trail->push_back({index(coords), allowed, false});
+    }
+    --unset_cells_by_allowed_count[std::popcount(allowed)];
+    allowed &= ~bit(value);
+    ++unset_cells_by_allowed_count[std::popcount(allowed)];
+    update_places(coords, bit(value), false);
+  }
+
+  // All cells are set (but maybe not consistently, if propagations are pending)
+  bool is_solved() const {
+    return set_count == size() * size();
+  }
+
+  // Each region has all values, so the Sudoku is solved consistently
+  bool all_regions_are_complete() const {
+    for (const Mask values : region_values) {
+      if (values != constants.all_values) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ public:
+  // From now on, record all changes on 'trail' (or stop recording if it's null)
+  void record_changes_on(Trail* trail_) {
+    trail = trail_;
+  }
+
+  // Undo the changes recorded after the trail had 'trail_size' elements
+  void undo_changes(const unsigned trail_size) {
+    assert(trail);
+    assert(trail_size <= trail->size());
+
+    while (trail->size() != trail_size) {
+      const Change& change = trail->back();
+      Mask& allowed = allowed_values[change.index];
+      const Coordinates coords = constants.cells()[change.index];
+      if (change.is_set) {
+        const unsigned value = std::countr_zero(allowed);
+        const auto [row, col] = coords;
+        set_in_rows[row] &= ~bit(col);
+        for (const unsigned region : constants.regions_of(coords)) {
+          region_values[region] &= ~bit(value);
+        }
+        --set_count;
+      } else {
+        --unset_cells_by_allowed_count[std::popcount(allowed)];
+      }
+      ++unset_cells_by_allowed_count[std::popcount(change.previously_allowed)];
+      update_places(coords, change.previously_allowed & ~allowed, true);
+      allowed = change.previously_allowed;
+      trail->pop_back();
+    }
+  }
+
+ private:
+  // Cell 'coords' stops (or starts again) allowing 'values': update its places in its regions
+  void update_places(const Coordinates& coords, const Mask values, const bool allowed) {
+    const auto [row, col] = coords;
+    const unsigned sqrt_size = constants.sqrt_size;
+    const auto& regions = constants.regions_of(coords);
+    // Same order as 'regions': row, column, square
+    const std::array<unsigned, 3> positions = {col, row, row % sqrt_size * sqrt_size + col % sqrt_size};
+    for (Mask remaining = values; remaining; remaining &= remaining - 1) {
+      const unsigned value = std::countr_zero(remaining);
+      for (unsigned i = 0; i != 3; ++i) {
+        if (allowed) {
+          places[regions[i] * size() + value] |= bit(positions[i]);
+        } else {
+          places[regions[i] * size() + value] &= ~bit(positions[i]);
+        }
+      }
+    }
+  }
+
+  unsigned index(const Coordinates& coords) const {
+    const auto [row, col] = coords;
+    assert(row < size());
+    assert(col < size());
+    return row * size() + col;
+  }
+
+  template<typename T, unsigned max_count>
+  using Array = typename Constants::template Array<T, max_count>;
+
+  template<typename T, unsigned max_count>
+  static Array<T, max_count> make_array(const unsigned count, const T& value) {
+    return Constants::template make_array<T, max_count>(count, value);
+  }
+
+ private:
+  // Empty for 'CompileTimeConstants'
+  [[no_unique_address]] Constants constants;
+  // One more element than there are cells, so that 32-bit gathers of the last cell stay inside the array
+  Array<Mask, max_size * max_size + 1> allowed_values;
+  // Bit 'col' of 'set_in_rows[row]' is set when cell (row, col) is set
+  Array<Mask, max_size> set_in_rows;
+  Array<Mask, 3 * max_size> region_values;
+  // Bit 'position' of 'places[region * size + value]' is set when cell 'constants.region(region)[position]'
+  // allows 'value'
+  Array<Mask, 3 * max_size * max_size> places;
+  // Sizes of the buckets of unset cells by number of allowed values, kept up to date by all changes
+  Array<uint16_t, max_size + 1> unset_cells_by_allowed_count;
+  unsigned set_count;
+  Trail* trail;
+};
+
+template<unsigned size>
+using ExplorableSudoku = BasicExplorableSudoku<CompileTimeConstants<size>>;
+
+template<typename Mask>
+using RuntimeExplorableSudoku = BasicExplorableSudoku<RuntimeConstants<Mask>>;
+
+#endif  // EXPLORATION_EXPLORABLE_SUDOKU_HPP_
@@ -0,0 +1,168 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_EXPLORATION_CONSTANTS_HPP_
+#define EXPLORATION_EXPLORATION_CONSTANTS_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <ranges>
+#include <type_traits>
+#include <vector>
+
+#include "../puzzle/runtime-sudoku.hpp"
+#include "../puzzle/sudoku-constants.hpp"
+#include "fixed-capacity-vector.hpp"
+#include "propagation-kernel.hpp"
+
+
+// Smallest unsigned integer type with (at least) one bit per value
+template<unsigned size>
+using ValuesMask = std::conditional_t<size <= 16, uint16_t, std::conditional_t<size <= 32, uint32_t, uint64_t>>;
+
+// 'ExplorableSudoku' and 'ExplorationSolver' are generic over their constants: either 'CompileTimeConstants<size>',
+// so that the compiler can specialize exploration for a size, or 'RuntimeConstants<Mask>', so that exploration
+// is compiled once for all sizes that fit in 'Mask'.
+// Both have the same interface. Containers with a number of elements that depends on the size are 'Array'
+// (of a fixed number of elements) and 'Vector' (of a fixed capacity). They are stored inline, with 'max_count'
+// elements, for compile-time sizes, and on the heap for runtime sizes, where 'max_count' is ignored.
+
+template<unsigned size_>
+class CompileTimeConstants {
+ public:
+  typedef ValuesMask<size_> Mask;
+
+  static constexpr unsigned size = size_;
+  // Events about Sudokus explored with these constants are 'Event<max_size>'
+  static constexpr unsigned max_size = size_;
+  static constexpr unsigned sqrt_size = SudokuConstants<size>::sqrt_size;
+  static constexpr unsigned peers_count = SudokuConstants<size>::peers_count;
+  static constexpr Mask all_values = size == 8 * sizeof(Mask) ? Mask(~Mask(0)) : Mask((Mask(1) << size) - 1);
+
+  template<typename T, unsigned max_count>
+  using Array = std::array<T, max_count>;
+
+  template<typename T, unsigned max_count>
+  using Vector = FixedCapacityVector<T, max_count>;
+
+  static constexpr bool allocates = false;
+
+ public:
+  template<typename T, unsigned max_count>
+  static Array<T, max_count> make_array(const unsigned count [[maybe_unused]], const T& value) {
+    assert(count == max_count);
+    Array<T, max_count> array;
+    array.fill(value);
+    return array;
+  }
+
+  template<typename T, unsigned max_count>
+  static Vector<T, max_count> make_vector(const unsigned capacity [[maybe_unused]]) {
+    assert(capacity == max_count);
+    return Vector<T, max_count>();
+  }
+
+  static const auto& values() { return SudokuConstants<size>::values; }
+  static const auto& cells() { return SudokuConstants<size>::cells; }
+  static const auto& region_indexes() { return SudokuConstants<size>::region_indexes; }
+
+  static const auto& region(const unsigned region) {
+    return SudokuConstants<size>::regions[region];
+  }
+
+  static const auto& regions_of(const Coordinates& coords) {
+    return SudokuConstants<size>::regions_of[coords.first][coords.second];
+  }
+
+  static const auto& peers(const Coordinates& coords) {
+    return SudokuConstants<size>::peers[coords.first][coords.second];
+  }
+
+  static PeersMask<size> peers_allowing(
+    const PropagationKernel kernel,
+    const Mask* allowed_values,
+    const unsigned cell_index,
+    const Mask bit
+  ) {
+    return ::peers_allowing<size>(kernel, allowed_values, cell_index, bit);
+  }
+};
+
+template<typename Mask_>
+class RuntimeConstants {
+ public:
+  typedef Mask_ Mask;
+
+  static constexpr unsigned max_size = 8 * sizeof(Mask);
+
+  template<typename T, unsigned max_count>
+  using Array = std::vector<T>;
+
+  template<typename T, unsigned max_count>
+  using Vector = std::vector<T>;
+
+  static constexpr bool allocates = true;
+
+ public:
+  explicit RuntimeConstants(const unsigned size_) :
+    tables(&RuntimeSudokuConstants::get(size_)),
+    size(size_),
+    sqrt_size(tables->sqrt_size),
+    peers_count(3 * size_ - 2 * sqrt_size - 1),
+    all_values(size_ == max_size ? Mask(~Mask(0)) : Mask((Mask(1) << size_) - 1))
+  {  // NOLINT(whitespace/braces)
+    assert(size <= max_size);
+  }
+
+ public:
+  template<typename T, unsigned max_count>
+  static Array<T, max_count> make_array(const unsigned count, const T& value) {
+    return Array<T, max_count>(count, value);
+  }
+
+  template<typename T, unsigned max_count>
+  static Vector<T, max_count> make_vector(const unsigned capacity) {
+    Vector<T, max_count> vector;
+    vector.reserve(capacity);
+    return vector;
+  }
+
+  auto values() const { return std::views::iota(0u, size); }
+  const auto& cells() const { return tables->cells; }
+  auto region_indexes() const { return std::views::iota(0u, 3 * size); }
+
+  const auto& region(const unsigned region) const {
+    return tables->regions[region];
+  }
+
+  const auto& regions_of(const Coordinates& coords) const {
+    return tables->regions_of[coords.first * size + coords.second];
+  }
+
+  const auto& peers(const Coordinates& coords) const {
+    return tables->peers[coords.first * size + coords.second];
+  }
+
+  RuntimePeersMask peers_allowing(
+    const PropagationKernel kernel,
+    const Mask* allowed_values,
+    const unsigned cell_index,
+    const Mask bit
+  ) const {
+    return ::peers_allowing<RuntimePeersMask>(
+      kernel, &tables->peer_indexes[cell_index * tables->padded_peers_count], peers_count,
+      tables->padded_peers_count, allowed_values, bit);
+  }
+
+ private:
+  const RuntimeSudokuConstants* tables;
+
+ public:
+  // Not 'const', so that Sudokus with these constants can be assigned
+  unsigned size;
+  unsigned sqrt_size;
+  unsigned peers_count;
+  Mask all_values;
+};
+
+#endif  // EXPLORATION_EXPLORATION_CONSTANTS_HPP_
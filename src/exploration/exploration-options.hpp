@@ -0,0 +1,67 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_EXPLORATION_OPTIONS_HPP_
+#define EXPLORATION_EXPLORATION_OPTIONS_HPP_
+
+#include <cstdint>
+
+#include "../parallel/cancellation.hpp"
+#include "../puzzle/budget.hpp"
+#include "deduction-rules.hpp"
+#include "propagation-kernel.hpp"
+
+
+struct ExplorationOptions {
+  // How to come back to the state before a rejected hypothesis
+  enum class Backtracking {
+    // Make each hypothesis on a copy of the Sudoku
+    copy,
+    // Make each hypothesis on the Sudoku itself, recording changes on a trail, and undo them on rejection
+    undo_trail,
+  };
+
+  Backtracking backtracking = Backtracking::copy;
+
+  PropagationKernel kernel = fastest_propagation_kernel();
+
+  // Tried when propagation alone can't go further, before making hypotheses
+  DeductionRules rules;
+
+  // Where to make hypotheses when deductions can't go further
+  enum class CellChoice {
+    // On the first cell with the fewest allowed values ("minimum remaining values")
+    mrv,
+    // On the cell with the fewest allowed values that has the most unset peers ("degree" tie-break)
+    mrv_degree,
+    // On the same cell as 'mrv', found faster thanks to the sizes of buckets of cells kept by 'ExplorableSudoku'
+    buckets,
+    // On the places of a value in a region, if it has fewer places than the 'mrv' cell has allowed values.
+    // These hypotheses are on different cells, so they are not surrounded by 'ExplorationStarts' and
+    // 'ExplorationIsDone' events, and can't be explained.
+    region,
+  };
+
+  CellChoice cell_choice = CellChoice::mrv;
+
+  // In which order to try the values allowed in the chosen cell
+  enum class ValueOrder {
+    ascending,
+    // Values allowed by the fewest unset peers first ("least constraining value")
+    least_constraining,
+    // Shuffled, using 'random_seed', e.g. to generate random solved Sudokus from an empty one
+    random,
+  };
+
+  ValueOrder value_order = ValueOrder::ascending;
+
+  // With 'ValueOrder::random', the same seed makes the same hypotheses
+  uint32_t random_seed = 0;
+
+  // Checked before each hypothesis: when cancelled, exploration stops and the Sudoku is reported as not solved
+  const Cancellation* cancellation = nullptr;
+
+  // Charged for each hypothesis: when exhausted, exploration gives up
+  Budget* budget = nullptr;
+};
+
+#endif  // EXPLORATION_EXPLORATION_OPTIONS_HPP_
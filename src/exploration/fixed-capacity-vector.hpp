@@ -0,0 +1,58 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_FIXED_CAPACITY_VECTOR_HPP_
+#define EXPLORATION_FIXED_CAPACITY_VECTOR_HPP_
+
+#include <array>
+#include <cassert>
+
+
+// A vector whose elements are stored inline, to never allocate on the heap.
+// All elements are constructed with the vector; "pushing" only assigns them.
+template<typename T, unsigned capacity>
+class FixedCapacityVector {
+ public:
+  FixedCapacityVector() : elements(), count(0) {}
+
+ public:
+  unsigned size() const { return count; }
+  bool empty() const { return count == 0; }
+
+  const T& operator[](const unsigned index) const {
+    assert(index < count);
+    return elements[index];
+  }
+
+  const T& back() const {
+    assert(count > 0);
+    return elements[count - 1];
+  }
+
+  T& back() {
+    assert(count > 0);
+    return elements[count - 1];
+  }
+
+  void push_back(const T& element) {
+    assert(count < capacity);
+    elements[count++] = element;
+  }
+
+  void pop_back() {
+    assert(count > 0);
+    --count;
+  }
+
+  void clear() {
+    count = 0;
+  }
+
+  auto begin() const { return elements.begin(); }
+  auto end() const { return elements.begin() + count; }
+
+ private:
+  std::array<T, capacity> elements;
+  unsigned count;
+};
+
+#endif  // EXPLORATION_FIXED_CAPACITY_VECTOR_HPP_
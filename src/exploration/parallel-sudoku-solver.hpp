@@ -0,0 +1,138 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_PARALLEL_SUDOKU_SOLVER_HPP_
+#define EXPLORATION_PARALLEL_SUDOKU_SOLVER_HPP_
+
+#include <bit>
+#include <mutex>
+#include <optional>
+
+#include <chrones.hpp>
+
+#include "../parallel/cancellation.hpp"
+#include "../parallel/work-stealing-pool.hpp"
+#include "../puzzle/budget.hpp"
+#include "../puzzle/sudoku.hpp"
+#include "sudoku-solver.hpp"
+
+
+// Splits the first levels of the search tree into tasks, run on a pool of threads. Each task applies the
+// deductions, then makes the hypotheses that sequential exploration would make, each as a new task with one
+// more given.
+// Below 'split_depth', tasks explore sequentially. The first solution found cancels all other tasks.
+// With a budget, all tasks charge it, so its limits apply to the whole Sudoku; the first task to exhaust it
+// cancels all other tasks.
+template<unsigned size>
+class ParallelExplorationSolver {
+ public:
+  ParallelExplorationSolver(const ExplorationOptions& options_, const unsigned jobs, const unsigned split_depth_) :
+    options(options_),
+    split_depth(split_depth_),
+    cancellation(),
+    mutex(),
+    solution(),
+    pool(jobs)
+  {
+    options.cancellation = &cancellation;
+  }
+
+ public:
+  std::optional<Sudoku<ValueCell, size>> solve(const Sudoku<ValueCell, size>& sudoku) {
+    CHRONE();
+
+    pool.submit([this, sudoku](unsigned) { explore(sudoku, 0); });
+    pool.wait();
+
+    return solution;
+  }
+
+ private:
+  void explore(const Sudoku<ValueCell, size>& sudoku, const unsigned depth) {
+    if (cancellation.is_cancelled()) {
+      return;
+    }
+
+    if (depth == split_depth) {
+      solve_sequentially(sudoku);
+      return;
+    }
+
+    const NullEventSink sink_event;
+    with_exploration_solver(sudoku, sink_event, options, [&](auto& solver) {
+      if (!solver.deduce()) {
+        return;
+      }
+      const auto& deduced = solver.get_sudoku();
+
+      Sudoku<ValueCell, size> deduced_sudoku;
+      for (const auto& coords : SudokuConstants<size>::cells) {
+        if (deduced.is_set(coords)) {
+          deduced_sudoku.cell(coords).set(deduced.get(coords));
+        }
+      }
+
+      if (deduced.is_solved()) {
+        found(deduced_sudoku);
+        return;
+      }
+
+      // The hypotheses sequential exploration would make, with the same 'cell_choice' and 'value_order'
+      for (const auto& [coords, value] : solver.get_first_hypotheses()) {
+        // These hypotheses are charged like the ones made by sequential exploration
+        if (options.budget && !options.budget->spend_hypothesis()) {
+          cancellation.cancel();
+          return;
+        }
+        Sudoku<ValueCell, size> hypothesis_sudoku = deduced_sudoku;
+        hypothesis_sudoku.cell(coords).set(value);
+        pool.submit([this, hypothesis_sudoku, depth](unsigned) { explore(hypothesis_sudoku, depth + 1); });
+      }
+    });
+  }
+
+  void solve_sequentially(const Sudoku<ValueCell, size>& sudoku) {
+    const auto solved = solve_using_exploration(sudoku, NullEventSink(), options);
+    if (solved) {
+      found(*solved);
+    } else if (options.budget && options.budget->gave_up()) {
+      // Other tasks would give up at their next hypothesis anyway
+      cancellation.cancel();
+    }
+  }
+
+  void found(const Sudoku<ValueCell, size>& solved) {
+    {
+      std::lock_guard lock(mutex);
+      if (!solution) {
+        solution = solved;
+      }
+    }
+    cancellation.cancel();
+  }
+
+ private:
+  ExplorationOptions options;
+  const unsigned split_depth;
+  Cancellation cancellation;
+  // Protects 'solution'
+  std::mutex mutex;
+  std::optional<Sudoku<ValueCell, size>> solution;
+  // Last, so that its threads are stopped before the other members are destroyed
+  WorkStealingPool pool;
+};
+
+// Enough levels for at least four tasks per thread, when each cell has only two allowed values
+inline unsigned default_split_depth(const unsigned jobs) {
+  return std::bit_width(jobs) + 2;
+}
+
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> solve_using_parallel_exploration(
+  const Sudoku<ValueCell, size>& sudoku,
+  const unsigned jobs,
+  const ExplorationOptions& options = {}
+) {
+  return ParallelExplorationSolver<size>(options, jobs, default_split_depth(jobs)).solve(sudoku);
+}
+
+#endif  // EXPLORATION_PARALLEL_SUDOKU_SOLVER_HPP_
@@ -0,0 +1,84 @@
+// Copyright 2023 Vincent Jacques
+
+#include "propagation-kernel.hpp"
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+PropagationKernel fastest_propagation_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  static const PropagationKernel kernel =
+    __builtin_cpu_supports("avx2") ? PropagationKernel::avx2 : PropagationKernel::scalar;
+  return kernel;
+#else
+  return PropagationKernel::scalar;
+#endif
+}
+
+
+// LCOV_EXCL_START
+
+static_assert(PeerIndexes<4>::padded_count == 8);
+static_assert(PeerIndexes<4>::indexes[0] == std::array<int32_t, PeerIndexes<4>::padded_count>{
+  1, 2, 3, 4, 8, 12, 5,
+  0,  // Padding
+});
+static_assert(PeerIndexes<9>::padded_count == 24);
+static_assert(PeerIndexes<25>::padded_count == 64);
+static_assert(PeerIndexes<64>::padded_count == 176);
+
+template<unsigned size, typename Mask>
+void check_kernels_agree() {
+  // One more element, as required by 'peers_allowing_avx2'
+  std::array<Mask, size * size + 1> allowed_values;
+  // Some arbitrary, but varied, masks
+  for (unsigned index = 0; index != allowed_values.size(); ++index) {
+    allowed_values[index] = Mask(index * 2654435761u);
+    if constexpr (sizeof(Mask) == 8) {
+      allowed_values[index] |= Mask(index * 2246822519u) << 32;
+    }
+  }
+
+  for (unsigned cell_index = 0; cell_index != size * size; ++cell_index) {
+    for (const unsigned value : SudokuConstants<size>::values) {
+      const Mask bit = Mask(1) << value;
+      const auto expected = peers_allowing_scalar<size>(allowed_values.data(), cell_index, bit);
+      for (unsigned i = 0; i != SudokuConstants<size>::peers_count; ++i) {
+        const auto [row, col] = SudokuConstants<size>::peers[cell_index / size][cell_index % size][i];
+        const bool is_allowed = allowed_values[row * size + col] & bit;
+        CHECK(((expected[i / 64] >> (i % 64)) & 1) == is_allowed);
+      }
+#if defined(__x86_64__) || defined(__i386__)
+      if (fastest_propagation_kernel() == PropagationKernel::avx2) {
+        CHECK(peers_allowing_avx2<size>(allowed_values.data(), cell_index, bit) == expected);
+      }
+#endif
+    }
+  }
+}
+
+TEST_CASE("propagation kernels - 4") {
+  check_kernels_agree<4, uint16_t>();
+}
+
+TEST_CASE("propagation kernels - 9") {
+  check_kernels_agree<9, uint16_t>();
+}
+
+TEST_CASE("propagation kernels - 16") {
+  check_kernels_agree<16, uint16_t>();
+}
+
+TEST_CASE("propagation kernels - 25") {
+  check_kernels_agree<25, uint32_t>();
+}
+
+TEST_CASE("propagation kernels - 36") {
+  check_kernels_agree<36, uint64_t>();
+}
+
+TEST_CASE("propagation kernels - 64") {
+  check_kernels_agree<64, uint64_t>();
+}
+
+// LCOV_EXCL_STOP
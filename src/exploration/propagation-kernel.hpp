@@ -0,0 +1,170 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_PROPAGATION_KERNEL_HPP_
+#define EXPLORATION_PROPAGATION_KERNEL_HPP_
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+#include "../puzzle/sudoku-constants.hpp"
+
+
+// How 'propagate' finds the peers of a cell that still allow its value
+enum class PropagationKernel {
+  // One peer at a time
+  scalar,
+  // Eight peers at a time (four with 64-bit masks), using AVX2 gathers. Only compiled for x86 targets.
+  avx2,
+};
+
+// The fastest kernel supported by the CPU running the program ('scalar' on non-x86 targets)
+PropagationKernel fastest_propagation_kernel();
+
+// Bit 'i' is set when the 'i'-th peer of a cell (in 'SudokuConstants<size>::peers') allows a value
+template<unsigned size>
+using PeersMask = std::array<uint64_t, (SudokuConstants<size>::peers_count + 63) / 64>;
+
+template<unsigned size>
+class PeerIndexes {
+ public:
+  // Rounded up to full AVX2 vectors
+  static constexpr unsigned padded_count = (SudokuConstants<size>::peers_count + 7) / 8 * 8;
+
+ private:
+  static constexpr auto make_indexes() {
+    std::array<std::array<int32_t, padded_count>, size * size> indexes;
+    for (const auto& [row, col] : SudokuConstants<size>::cells) {
+      unsigned i = 0;
+      SudokuConstants<size>::for_each_peer(row, col, [&](const Coordinates& peer) {
+        indexes[row * size + col][i++] = peer.first * size + peer.second;
+      });
+      // Padding refers to the cell itself, and is masked out of the result
+      for (; i != padded_count; ++i) {
+        indexes[row * size + col][i] = row * size + col;
+      }
+    }
+    return indexes;
+  }
+
+ public:
+  // 'indexes[row * size + col]' are the indexes (as in 'row * size + col') of the peers of cell (row, col)
+  static constexpr const auto& indexes =
+    PrecomputedTable<&make_indexes, SudokuConstants<size>::peer_tables_at_compile_time>::table;
+};
+
+// Like 'PeersMask<size>', for a size only known at runtime: room for the 175 peers of a cell of a 64x64 Sudoku
+typedef std::array<uint64_t, 3> RuntimePeersMask;
+
+// 'allowed_values' are the masks of allowed values of all cells, indexed by 'row * size + col'.
+// 'indexes' are the indexes (as in 'row * size + col') of the 'peers_count' peers of a cell, padded up to
+// 'padded_count' (a multiple of 8) with the index of the cell itself, like 'PeerIndexes<size>::indexes'.
+template<typename PeersMask, typename Mask>
+PeersMask peers_allowing_scalar(
+  const int32_t* indexes,
+  const unsigned peers_count,
+  const Mask* allowed_values,
+  const Mask bit
+) {
+  PeersMask peers_mask{};
+  for (unsigned i = 0; i != peers_count; ++i) {
+    peers_mask[i / 64] |= uint64_t((allowed_values[indexes[i]] & bit) != 0) << (i % 64);
+  }
+  return peers_mask;
+}
+
+template<unsigned size, typename Mask>
+PeersMask<size> peers_allowing_scalar(const Mask* allowed_values, const unsigned cell_index, const Mask bit) {
+  return peers_allowing_scalar<PeersMask<size>>(
+    PeerIndexes<size>::indexes[cell_index].data(), SudokuConstants<size>::peers_count, allowed_values, bit);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Requires 'allowed_values' to be readable for 4 bytes from each element
+template<typename PeersMask, typename Mask>
+__attribute__((target("avx2")))
+PeersMask peers_allowing_avx2(
+  const int32_t* indexes,
+  const unsigned peers_count,
+  const unsigned padded_count,
+  const Mask* allowed_values,
+  const Mask bit
+) {
+  PeersMask peers_mask{};
+  const __m256i zero = _mm256_setzero_si256();
+  if constexpr (sizeof(Mask) == 8) {
+    const __m256i bits = _mm256_set1_epi64x(bit);
+    for (unsigned i = 0; i != padded_count; i += 4) {
+      const __m128i peer_indexes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&indexes[i]));
+      const __m256i peer_masks = _mm256_i32gather_epi64(
+        reinterpret_cast<const long long*>(allowed_values), peer_indexes, sizeof(Mask));  // NOLINT(runtime/int)
+      const __m256i disallowed = _mm256_cmpeq_epi64(_mm256_and_si256(peer_masks, bits), zero);
+      const unsigned allowed = ~_mm256_movemask_pd(_mm256_castsi256_pd(disallowed)) & 0xF;
+      peers_mask[i / 64] |= uint64_t(allowed) << (i % 64);
+    }
+  } else {
+    static_assert(sizeof(Mask) <= 4, "gathers load 32 bits per peer");
+    // The bits of the next cells, loaded by 32-bit gathers when masks are narrower, are removed by this AND
+    const __m256i bits = _mm256_set1_epi32(bit);
+    for (unsigned i = 0; i != padded_count; i += 8) {
+      const __m256i peer_indexes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&indexes[i]));
+      const __m256i peer_masks = _mm256_i32gather_epi32(
+        reinterpret_cast<const int*>(allowed_values), peer_indexes, sizeof(Mask));
+      const __m256i disallowed = _mm256_cmpeq_epi32(_mm256_and_si256(peer_masks, bits), zero);
+      const unsigned allowed = ~_mm256_movemask_ps(_mm256_castsi256_ps(disallowed)) & 0xFF;
+      peers_mask[i / 64] |= uint64_t(allowed) << (i % 64);
+    }
+  }
+  // Remove the padding
+  if (peers_count % 64 != 0) {
+    peers_mask[peers_count / 64] &= (uint64_t(1) << (peers_count % 64)) - 1;
+  }
+  return peers_mask;
+}
+
+template<unsigned size, typename Mask>
+__attribute__((target("avx2")))
+PeersMask<size> peers_allowing_avx2(const Mask* allowed_values, const unsigned cell_index, const Mask bit) {
+  return peers_allowing_avx2<PeersMask<size>>(
+    PeerIndexes<size>::indexes[cell_index].data(), SudokuConstants<size>::peers_count, PeerIndexes<size>::padded_count,
+    allowed_values, bit);
+}
+#endif
+
+template<typename PeersMask, typename Mask>
+PeersMask peers_allowing(
+  const PropagationKernel kernel [[maybe_unused]],
+  const int32_t* indexes,
+  const unsigned peers_count,
+  const unsigned padded_count [[maybe_unused]],
+  const Mask* allowed_values,
+  const Mask bit
+) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (kernel == PropagationKernel::avx2) {
+    return peers_allowing_avx2<PeersMask>(indexes, peers_count, padded_count, allowed_values, bit);
+  }
+#endif
+  return peers_allowing_scalar<PeersMask>(indexes, peers_count, allowed_values, bit);
+}
+
+template<unsigned size, typename Mask>
+PeersMask<size> peers_allowing(
+  const PropagationKernel kernel [[maybe_unused]],
+  const Mask* allowed_values,
+  const unsigned cell_index,
+  const Mask bit
+) {
+#if defined(__x86_64__) || defined(__i386__)
+  if (kernel == PropagationKernel::avx2) {
+    return peers_allowing_avx2<size>(allowed_values, cell_index, bit);
+  }
+#endif
+  return peers_allowing_scalar<size>(allowed_values, cell_index, bit);
+}
+
+#endif  // EXPLORATION_PROPAGATION_KERNEL_HPP_
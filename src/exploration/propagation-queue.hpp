@@ -0,0 +1,59 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef EXPLORATION_PROPAGATION_QUEUE_HPP_
+#define EXPLORATION_PROPAGATION_QUEUE_HPP_
+
+#include <cassert>
+
+#include "../puzzle/sudoku-constants.hpp"
+#include "exploration-constants.hpp"
+
+
+// The cells whose values remain to be propagated, in the order they were set.
+// A cell is set only once, so it's queued at most once: 'size * size' is enough capacity,
+// and there is no need to reuse the space of cells already popped.
+template<typename Constants>
+class PropagationQueue {
+  static constexpr unsigned max_size = Constants::max_size;
+
+ public:
+  explicit PropagationQueue(const Constants& constants_) :
+    constants(constants_),
+    cells(Constants::template make_vector<Coordinates, max_size * max_size>(constants.size * constants.size)),
+    head(0),
+    queued(Constants::template make_array<bool, max_size * max_size>(constants.size * constants.size, false))
+  {}
+
+ public:
+  bool empty() const {
+    return head == cells.size();
+  }
+
+  void push_back(const Coordinates& coords) {
+    const auto [row, col] = coords;
+    assert(!queued[row * constants.size + col]);
+    queued[row * constants.size + col] = true;
+    cells.push_back(coords);
+  }
+
+  Coordinates pop_front() {
+    assert(!empty());
+    return cells[head++];
+  }
+
+  void clear() {
+    for (const auto& [row, col] : cells) {
+      queued[row * constants.size + col] = false;
+    }
+    cells.clear();
+    head = 0;
+  }
+
+ private:
+  [[no_unique_address]] Constants constants;
+  typename Constants::template Vector<Coordinates, max_size * max_size> cells;
+  unsigned head;
+  typename Constants::template Array<bool, max_size * max_size> queued;
+};
+
+#endif  // EXPLORATION_PROPAGATION_QUEUE_HPP_
@@ -0,0 +1,238 @@
+// Copyright 2023 Vincent Jacques
+
+#include "sudoku-solver.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+template class BasicExplorationSolver<RuntimeConstants<uint16_t>, const NullEventSink>;
+template class BasicExplorationSolver<RuntimeConstants<uint32_t>, const NullEventSink>;
+template class BasicExplorationSolver<RuntimeConstants<uint64_t>, const NullEventSink>;
+
+template<typename Mask>
+RuntimeExplorationSolver<Mask>& get_runtime_exploration_solver(const unsigned size, const ExplorationOptions& options) {
+  static const NullEventSink sink_event;
+  // Like 'RuntimeSudokuConstants::get', a thread usually solves Sudokus of a single size
+  thread_local RuntimeExplorationSolver<Mask>* last = nullptr;
+  thread_local unsigned last_size = 0;
+  if (last == nullptr || last_size != size) {
+    thread_local std::map<unsigned, std::unique_ptr<RuntimeExplorationSolver<Mask>>> solvers;
+    auto& solver = solvers[size];
+    if (!solver) {
+      solver = std::make_unique<RuntimeExplorationSolver<Mask>>(RuntimeConstants<Mask>(size), sink_event, options);
+    }
+    last = solver.get();
+    last_size = size;
+  }
+  last->reset(options);
+  return *last;
+}
+
+template RuntimeExplorationSolver<uint16_t>& get_runtime_exploration_solver(unsigned, const ExplorationOptions&);
+template RuntimeExplorationSolver<uint32_t>& get_runtime_exploration_solver(unsigned, const ExplorationOptions&);
+template RuntimeExplorationSolver<uint64_t>& get_runtime_exploration_solver(unsigned, const ExplorationOptions&);
+
+
+// LCOV_EXCL_START
+
+namespace {
+
+const char* const expert_9 =
+  "...5..4...15.....3....7...9..4...82.2..9...7.8.........6...4......782...34...9...";
+// 'expert_9' without its last clues, so it has many solutions
+const char* const ambiguous_9 =
+  "...5..4...15.....3....7...9..4...82.2..9...7.8.........6...4......782............";
+const char* const expert_16 =
+  "..862....AC....7"
+  ".2.C..39...18..A"
+  "5.4.6...E2..B.G."
+  "AD.14...6...E..."
+  "D.6E.8..9......."
+  "....D7E.G..84..C"
+  ".1...5....6E98.G"
+  ".G........F.27E."
+  "..25GA..18....D6"
+  "4.E.....3..71C.."
+  "7.....D4..96A..5"
+  ".A...9F..ED5...4"
+  ".B58.69C.34.G1A2"
+  "......B5.6..C4.."
+  "..7....G5...F.3B"
+  "GE...D4.C.1B6.5.";
+
+std::vector<ExplorationOptions> make_all_options() {
+  typedef ExplorationOptions::Backtracking Backtracking;
+  typedef ExplorationOptions::CellChoice CellChoice;
+  typedef ExplorationOptions::ValueOrder ValueOrder;
+
+  std::vector<ExplorationOptions> all_options;
+  for (const auto backtracking : {Backtracking::copy, Backtracking::undo_trail}) {
+    for (const DeductionRules& rules : {DeductionRules{}, DeductionRules{true, true, true, true, true}}) {
+      for (const auto cell_choice : {
+        CellChoice::mrv, CellChoice::mrv_degree, CellChoice::buckets, CellChoice::region,
+      }) {
+        for (const auto value_order : {ValueOrder::ascending, ValueOrder::least_constraining, ValueOrder::random}) {
+          ExplorationOptions options;
+          options.backtracking = backtracking;
+          options.rules = rules;
+          options.cell_choice = cell_choice;
+          options.value_order = value_order;
+          options.random_seed = 42;
+          all_options.push_back(options);
+        }
+      }
+    }
+  }
+  // Each rule alone
+  for (const DeductionRules& rules : {
+    DeductionRules{.naked_pairs = true}, DeductionRules{.hidden_pairs = true}, DeductionRules{.pointing_pairs = true},
+    DeductionRules{.box_line_reductions = true}, DeductionRules{.x_wings = true},
+  }) {
+    ExplorationOptions options;
+    options.rules = rules;
+    all_options.push_back(options);
+  }
+  return all_options;
+}
+
+template<unsigned size>
+std::unique_ptr<ExplorationSolver<size, const NullEventSink>> make_compiled_solver(
+  const Sudoku<ValueCell, size>& sudoku,
+  const ExplorationOptions& options
+) {
+  static const NullEventSink sink_event;
+  auto solver = std::make_unique<ExplorationSolver<size, const NullEventSink>>(
+    CompileTimeConstants<size>(), sink_event, options);
+  set_exploration_inputs(sudoku, solver.get());
+  return solver;
+}
+
+template<unsigned size>
+RuntimeExplorationSolver<ValuesMask<size>>& get_runtime_solver(
+  const Sudoku<ValueCell, size>& sudoku,
+  const ExplorationOptions& options
+) {
+  auto& solver = get_runtime_exploration_solver<ValuesMask<size>>(size, options);
+  set_exploration_inputs(sudoku, &solver);
+  return solver;
+}
+
+// Same solution, after the same hypotheses, with compile-time and runtime constants
+template<unsigned size>
+void check_solve(const Sudoku<ValueCell, size>& sudoku, const std::vector<ExplorationOptions>& all_options) {
+  for (const auto& options : all_options) {
+    const auto expected = make_compiled_solver(sudoku, options);
+    const bool expected_solved = expected->solve();
+
+    auto& solver = get_runtime_solver(sudoku, options);
+    const bool solved = solver.solve();
+
+    CHECK(solved == expected_solved);
+    CHECK(solver.get_hypotheses_count() == expected->get_hypotheses_count());
+    if (solved && expected_solved) {
+      for (const auto& coords : SudokuConstants<size>::cells) {
+        CHECK(solver.get_sudoku().get(coords) == expected->get_sudoku().get(coords));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("exploration - runtime constants - same as compile-time constants - 9") {
+  check_solve(Sudoku<ValueCell, 9>::from_string(expert_9), make_all_options());
+}
+
+TEST_CASE("exploration - runtime constants - same as compile-time constants - 16") {
+  // A few options only, because debug checks make larger sizes slow
+  std::vector<ExplorationOptions> all_options(4);
+  all_options[1].rules = {true, true, true, true, true};
+  all_options[2].backtracking = ExplorationOptions::Backtracking::undo_trail;
+  all_options[2].cell_choice = ExplorationOptions::CellChoice::region;
+  all_options[2].value_order = ExplorationOptions::ValueOrder::least_constraining;
+  all_options[3].cell_choice = ExplorationOptions::CellChoice::mrv_degree;
+  all_options[3].value_order = ExplorationOptions::ValueOrder::random;
+  check_solve(Sudoku<ValueCell, 16>::from_string(expert_16), all_options);
+}
+
+TEST_CASE("exploration - runtime constants - same as compile-time constants - empty 4") {
+  check_solve(Sudoku<ValueCell, 4>(), make_all_options());
+}
+
+TEST_CASE("exploration - runtime constants - same count as compile-time constants") {
+  for (const auto& [line, limit] : {
+    std::make_pair(expert_9, std::optional<unsigned>()),
+    std::make_pair(ambiguous_9, std::optional(0u)),
+    std::make_pair(ambiguous_9, std::optional(1u)),
+    std::make_pair(ambiguous_9, std::optional(7u)),
+  }) {
+    const auto sudoku = Sudoku<ValueCell, 9>::from_string(line);
+    for (const auto& options : make_all_options()) {
+      const unsigned expected = make_compiled_solver(sudoku, options)->count(limit);
+      CHECK(get_runtime_solver(sudoku, options).count(limit) == expected);
+    }
+  }
+}
+
+TEST_CASE("exploration - runtime constants - same deductions as compile-time constants") {
+  const auto sudoku = Sudoku<ValueCell, 9>::from_string(expert_9);
+  for (const auto& options : make_all_options()) {
+    const auto expected = make_compiled_solver(sudoku, options);
+    CHECK(expected->deduce());
+
+    auto& solver = get_runtime_solver(sudoku, options);
+    CHECK(solver.deduce());
+    for (const auto& coords : SudokuConstants<9>::cells) {
+      CHECK(solver.get_sudoku().allowed(coords) == expected->get_sudoku().allowed(coords));
+    }
+  }
+}
+
+TEST_CASE("exploration - runtime constants - same first hypotheses as compile-time constants") {
+  const auto sudoku = Sudoku<ValueCell, 9>::from_string(expert_9);
+  for (const auto& options : make_all_options()) {
+    const auto expected_solver = make_compiled_solver(sudoku, options);
+    CHECK(expected_solver->deduce());
+    auto& solver = get_runtime_solver(sudoku, options);
+    CHECK(solver.deduce());
+    CHECK(solver.get_sudoku().is_solved() == expected_solver->get_sudoku().is_solved());
+    if (expected_solver->get_sudoku().is_solved()) {
+      // Some deduction rules solve 'expert_9' without hypotheses
+      continue;
+    }
+
+    const auto expected = expected_solver->get_first_hypotheses();
+    const auto hypotheses = solver.get_first_hypotheses();
+    CHECK(hypotheses.size() == expected.size());
+    for (unsigned i = 0; i != std::min(hypotheses.size(), expected.size()); ++i) {
+      CHECK(hypotheses[i] == expected[i]);
+    }
+  }
+}
+
+TEST_CASE("exploration - runtime constants - unsolvable") {
+  for (const char* const line : {"1..4..2..2..3..1", "1..1............"}) {
+    const auto sudoku = Sudoku<ValueCell, 4>::from_string(line);
+    CHECK(!get_runtime_solver(sudoku, {}).solve());
+    CHECK(!make_compiled_solver(sudoku, {})->deduce());
+    CHECK(!get_runtime_solver(sudoku, {}).deduce());
+  }
+}
+
+TEST_CASE("exploration - runtime constants - reused solver") {
+  const auto sudoku = Sudoku<ValueCell, 9>::from_string(expert_9);
+  const auto expected = solve_using_exploration(sudoku)->to_string();
+  for (unsigned i = 0; i != 3; ++i) {
+    auto& solver = get_runtime_solver(Sudoku<ValueCell, 9>::from_string(ambiguous_9), {});
+    CHECK(solver.count(std::nullopt) > 1);
+    CHECK(get_exploration_solution<9>(&get_runtime_solver(sudoku, {}))->to_string() == expected);
+  }
+}
+
+// LCOV_EXCL_STOP
@@ -3,326 +3,264 @@
 #ifndef EXPLORATION_SUDOKU_SOLVER_HPP_
 #define EXPLORATION_SUDOKU_SOLVER_HPP_
 
+#include <algorithm>
 #include <array>
-#include <bitset>
+#include <bit>
 #include <cassert>
-#include <deque>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <random>
 #include <string>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
 #include <chrones.hpp>
 
+#include "../parallel/cancellation.hpp"
+#include "../puzzle/budget.hpp"
 #include "../puzzle/sudoku.hpp"
+#include "deduction-rules.hpp"
 #include "events.hpp"
+#include "explorable-sudoku.hpp"
+#include "exploration-constants.hpp"
+#include "exploration-options.hpp"
+#include "fixed-capacity-vector.hpp"
+#include "propagation-kernel.hpp"
+#include "propagation-queue.hpp"
 
 
-template<unsigned size>
-class ExplorableCell {
- public:
-  ExplorableCell() :
-    allowed_values(),
-    set_value()
+// Make sure a closing event is added, however the scope is exited
+template<typename EventSink, typename EventIn, typename EventOut>
+struct EventsPairGuard {
+  EventsPairGuard(
+    EventSink& sink_event_,  // NOLINT(runtime/references)
+    const EventIn& in,
+    const EventOut& out_
+  ) :  // NOLINT(whitespace/parens)
+    sink_event(sink_event_),
+    out(out_)
   {  // NOLINT(whitespace/braces)
-    allowed_values.set();
-    assert_invariants();
+    if constexpr (!is_null_event_sink<EventSink>) {
+      sink_event(in);
+    }
   }
 
-  ExplorableCell(const ExplorableCell&) = default;
-  ExplorableCell& operator=(const ExplorableCell&) = default;
-  ExplorableCell(ExplorableCell&&) = default;
-  ExplorableCell& operator=(ExplorableCell&&) = default;
-
- public:
-  bool is_set() const {
-    assert_invariants();
-    return set_value.has_value();
+  ~EventsPairGuard() {
+    if constexpr (!is_null_event_sink<EventSink>) {
+      sink_event(out);
+    }
   }
 
-  unsigned get() const {
-    assert_invariants();
-    assert(is_set());
+  EventSink& sink_event;
+  EventOut out;
+};
 
-    return set_value.value();
-  }
 
-  bool is_allowed(const unsigned value) const {
-    assert_invariants();
-    assert(value < size);
+// Exploration, generic over its constants (see 'exploration-constants.hpp').
+// With runtime constants, a solver can be reused for several Sudokus of the same size: 'reset' it, then set the
+// inputs of the next Sudoku. It then reuses its memory, so that exploration doesn't allocate.
+template<typename Constants, typename EventSink>
+class BasicExplorationSolver {
+ public:
+  typedef BasicExplorableSudoku<Constants> Explorable;
 
-    return allowed_values.test(value);
+  BasicExplorationSolver(
+    const Constants& constants_,
+    EventSink& sink_event_,
+    const ExplorationOptions& options_
+  ) :  // NOLINT(whitespace/parens)
+    constants(constants_),
+    sink_event(sink_event_),
+    options(options_),
+    random(options_.random_seed),
+    inputs(Constants::template make_vector<Input, max_size * max_size>(size() * size())),
+    explored_sudoku(constants_),
+    to_propagate(constants_),
+    trail(Constants::template make_vector<Change, max_size * max_size * max_size>(size() * size() * size())),
+    frames(Constants::template make_vector<Frame, max_size * max_size>(size() * size())),
+    copied_levels(std::min(size() * size(), (256 * 1024) / Explorable::footprint(size()))),
+    copies(Constants::template make_array<std::optional<Explorable>, max_copied_levels>(copied_levels, std::nullopt)),
+    copied_count(0),
+    counting(false),
+    solutions_limit(),
+    solutions_count(0),
+    hypotheses_count(0)
+  {  // NOLINT(whitespace/braces)
+    if constexpr (Constants::allocates) {
+      // Allocate all copies now, so that making them later doesn't allocate
+      for (auto& copy : copies) {
+        copy.emplace(explored_sudoku);
+      }
+    }
   }
 
-  unsigned allowed_count() const {
-    assert_invariants();
-
-    return allowed_values.count();
+ public:
+  // Forget the inputs, and the results of the last exploration, to explore another Sudoku with these options
+  void reset(const ExplorationOptions& options_) {
+    options = options_;
+    random.seed(options.random_seed);
+    inputs.clear();
+    to_propagate.clear();
+    trail.clear();
+    frames.clear();
+    copied_count = 0;
+    counting = false;
+    solutions_limit.reset();
+    solutions_count = 0;
+    hypotheses_count = 0;
   }
 
-  unsigned get_single_allowed_value() const {
-    assert_invariants();
-    assert(allowed_count() == 1);
-
-    for (unsigned value : SudokuConstants<size>::values) {
-      if (is_allowed(value)) {
-        return value;
-      }
-    }
-    __builtin_unreachable();
+  // The inputs are set in this order, which is the order of their 'CellIsSetInInput' events
+  void set_input(const Coordinates& coords, const unsigned value) {
+    assert(value < size());
+    inputs.push_back({coords, value});
   }
 
-  std::bitset<size> set(const unsigned value) {
-    assert_invariants();
-    assert(value < size);
-    assert(is_allowed(value));
-    assert(!is_set());
-
-    std::bitset<size> previously_allowed(allowed_values);
-    previously_allowed.reset(value);
+  // Returns true if the Sudoku is solved, in 'get_sudoku'
+  bool solve() {
+    CHRONE();
 
-    allowed_values.reset();
-    allowed_values.set(value);
-    set_value = value;
+    Explorable* const sudoku = &explored_sudoku;
+    set_inputs(sudoku);
 
-    assert_invariants();
+    if (options.backtracking == ExplorationOptions::Backtracking::undo_trail) {
+      sudoku->record_changes_on(&trail);
+    }
 
-    return previously_allowed;
+    switch (propagate_and_explore(sudoku)) {
+      case ExplorationResult::solved:
+        return true;
+      case ExplorationResult::unsolvable:
+      case ExplorationResult::stopped:
+        return false;
+    }
+    __builtin_unreachable();
   }
 
-  void forbid(const unsigned value) {
-    assert_invariants();
-    assert(value < size);
-    assert(is_allowed(value));
+  // Keeps exploring after each solution, until all hypotheses are rejected or 'limit' solutions are found.
+  // Returns the number of solutions found (a lower bound if exploration was stopped).
+  // Always undoes rejected hypotheses using the trail, to avoid copying the Sudoku at each level of the search.
+  unsigned count(const std::optional<unsigned> limit) {
+    CHRONE();
 
-    allowed_values.reset(value);
+    if (limit == 0u) {
+      return 0;
+    }
 
-    assert_invariants();
-  }
+    counting = true;
+    solutions_limit = limit;
+    solutions_count = 0;
+    options.backtracking = ExplorationOptions::Backtracking::undo_trail;
 
- private:
-  void assert_invariants() const {
-    // At least one value is always allowed
-    assert(allowed_values.any());
+    Explorable* const sudoku = &explored_sudoku;
+    set_inputs(sudoku);
+    sudoku->record_changes_on(&trail);
+    propagate_and_explore(sudoku);
 
-    // 'set_value' forces 'allowed_values'
-    if (set_value.has_value()) {
-      assert(allowed_values.count() == 1);
-      assert(allowed_values.test(set_value.value()));
-    }
+    return solutions_count;
   }
 
- private:
-  // @todo Use a std::variant? (Because we never use both members at the same time)
-  std::bitset<size> allowed_values;
-  std::optional<unsigned> set_value;
-};
+  // Like 'solve', but without making hypotheses: returns false if deductions prove the Sudoku unsolvable,
+  // and otherwise leaves it as far as they go (maybe solved) in 'get_sudoku'
+  bool deduce() {
+    CHRONE();
 
-template<unsigned size>
-class Sudoku<ExplorableCell<size>, size> : public SudokuBase<ExplorableCell<size>, size> {
- public:
-  bool is_solved() const {
-    for (const auto& cell : this->cells()) {
-      if (!cell.is_set()) {
+    Explorable* const sudoku = &explored_sudoku;
+    set_inputs(sudoku);
+    switch (propagate_and_deduce(sudoku)) {
+      case PropagationResult::solved:
+      case PropagationResult::requires_exploration:
+        return true;
+      case PropagationResult::unsolvable:
         return false;
-      }
     }
-    return true;
+    __builtin_unreachable();
   }
-};
 
-// Make sure a closing event is added, however the scope is exited
-template<typename EventSink, typename EventIn, typename EventOut>
-struct EventsPairGuard {
-  EventsPairGuard(
-    EventSink& sink_event_,  // NOLINT(runtime/references)
-    const EventIn& in,
-    const EventOut& out_
-  ) :  // NOLINT(whitespace/parens)
-    sink_event(sink_event_),
-    out(out_)
-  {  // NOLINT(whitespace/braces)
-    sink_event(in);
-  }
+  const Explorable& get_sudoku() const { return explored_sudoku; }
 
-  ~EventsPairGuard() {
-    sink_event(out);
+  typedef FixedCapacityVector<std::pair<Coordinates, unsigned>, Constants::max_size> Hypotheses;
+
+  // The hypotheses that 'solve' would make first, after 'deduce' returned true with an unsolved Sudoku
+  Hypotheses get_first_hypotheses() {
+    assert(!explored_sudoku.is_solved());
+    bool on_cell;
+    return get_hypotheses(explored_sudoku, &on_cell);
   }
 
-  EventSink& sink_event;
-  EventOut out;
-};
+  // Made by the last 'solve' or 'count'
+  unsigned get_hypotheses_count() const { return hypotheses_count; }
 
+ private:
+  typedef typename Constants::Mask Mask;
+  typedef typename Explorable::Change Change;
+  typedef std::pair<Coordinates, unsigned> Input;
 
-template<unsigned size, typename EventSink>
-class ExplorationSolver {
- public:
-  ExplorationSolver(
-    const Sudoku<ValueCell, size>& input_sudoku_,
-    EventSink& sink_event_
-  ) :  // NOLINT(whitespace/parens)
-    input_sudoku(input_sudoku_),
-    sink_event(sink_event_)
-  {}
+  static constexpr unsigned max_size = Constants::max_size;
 
- public:
-  std::optional<Sudoku<ValueCell, size>> solve() {
-    CHRONE();
+  unsigned size() const { return constants.size; }
 
-    Sudoku<ExplorableCell<size>, size> sudoku;
-    std::deque<Coordinates> to_propagate;
-    std::vector<std::pair<Coordinates, std::bitset<size>>> initial_deductions;
-    for (const auto& cell : input_sudoku.cells()) {
-      const auto value = cell.get();
-      if (value) {
-        const Coordinates coords = cell.coordinates();
-        sink_event(CellIsSetInInput<size>(coords, *value));
-        to_propagate.push_back(coords);
-        initial_deductions.emplace_back(coords, sudoku.cell(coords).set(*value));
-      }
+  void set_inputs(Explorable* sudoku) {
+    sudoku->reset();
+    for (const auto& [coords, value] : inputs) {
+      sink<CellIsSetInInput>(coords, value);
+      to_propagate.push_back(coords);
+      sudoku->set(coords, value);
     }
 
-    sink_event(InputsAreDone<size>());
+    sink<InputsAreDone>();
 
-    for (const auto& [coords, previously_allowed] : initial_deductions) {
-      deduce_after_set(&sudoku, coords, previously_allowed, &to_propagate);
+    // Cells are only forbidden values by propagation, so each input previously allowed all other values
+    for (const auto& [coords, value] : inputs) {
+      deduce_after_set(sudoku, coords, constants.all_values & ~Explorable::bit(value));
     }
 
-    #ifndef NDEBUG
-    // All single-value deductions have been applied
-    for (const auto& cell : sudoku.cells()) {
-      assert(cell.is_set() || cell.allowed_count() > 1);
-    }
-    // All single-place deductions have been applied
-    for (const auto& region : sudoku.regions()) {
-      for (const unsigned value : SudokuConstants<size>::values) {
-        unsigned count = 0;
-        const typename Sudoku<ExplorableCell<size>, size>::Cell* single_cell = nullptr;
-        for (const auto& cell : region.cells()) {
-          if (cell.is_allowed(value)) {
-            ++count;
-            single_cell = &cell;
-          }
-        }
-        assert(!(count == 1 && !single_cell->is_set()));
-      }
-    }
-    #endif
+    assert_all_deductions_are_applied(*sudoku);
 
-    if (sudoku.is_solved()) {
-      sink_event(SudokuIsSolved<size>());
-    }
-
-    switch (propagate_and_explore(&sudoku, std::move(to_propagate))) {
-      case ExplorationResult::solved: {
-        std::optional<Sudoku<ValueCell, size>> solved(std::in_place);
-        for (const auto& cell : sudoku.cells()) {
-          if (cell.is_set()) {
-            solved->cell(cell.coordinates()).set(cell.get());
-          }
-        }
-        return solved;
-      }
-      case ExplorationResult::unsolvable:
-        return std::nullopt;
+    if (sudoku->is_solved()) {
+      sink<SudokuIsSolved>();
     }
-    __builtin_unreachable();
   }
 
- private:
   enum class PropagationResult { solved, unsolvable, requires_exploration };
 
-  PropagationResult propagate(Sudoku<ExplorableCell<size>, size>* sudoku, std::deque<Coordinates>&& to_propagate) {
+  PropagationResult propagate(Explorable* sudoku) {
     CHRONE();
 
-    for (const auto& coords : to_propagate) {
-      assert(std::count(to_propagate.begin(), to_propagate.end(), coords) == 1);
-    }
-
     EventsPairGuard guard(
       sink_event,
-      PropagationStartsForSudoku<size>(),
-      PropagationIsDoneForSudoku<size>());
+      PropagationStartsForSudoku<max_size>(),
+      PropagationIsDoneForSudoku<max_size>());
 
+    bool solved = sudoku->is_solved() && sudoku->all_regions_are_complete();
     while (!to_propagate.empty()) {
-      const auto source_coords = to_propagate.front();
-      to_propagate.pop_front();
-      auto& source_cell = sudoku->cell(source_coords);
-      assert(source_cell.is_set());
-      const unsigned source_value = source_cell.get();
+      const auto source_coords = to_propagate.pop_front();
+      assert(sudoku->is_set(source_coords));
+      const unsigned source_value = sudoku->get(source_coords);
 
       EventsPairGuard guard(
         sink_event,
-        PropagationStartsForCell<size>(source_coords, source_value),
-        PropagationIsDoneForCell<size>(source_coords, source_value));
-
-      for (auto& source_region : source_cell.regions()) {
-        for (auto& target_cell : source_region.cells()) {
-          const auto target_coords = target_cell.coordinates();
-          if (target_cell != source_cell) {
-            if (target_cell.is_set()) {
-              if (target_cell.get() == source_value) {
-                return PropagationResult::unsolvable;
-              }
-            } else {
-              assert(target_cell.allowed_count() > 1);
-              if (target_cell.is_allowed(source_value)) {
-                sink_event(CellPropagates<size>(source_coords, target_coords, source_value));
-                target_cell.forbid(source_value);
-
-                if (target_cell.allowed_count() == 1) {
-                  const unsigned set_value = target_cell.get_single_allowed_value();
-                  sink_event(CellIsDeducedFromSingleAllowedValue<size>(target_coords, set_value));
-                  const auto previously_allowed = target_cell.set(set_value);
-                  assert(previously_allowed.count() == 0);  // No need to call 'deduce_after_set'
-
-                  assert(std::count(to_propagate.begin(), to_propagate.end(), target_coords) == 0);
-                  to_propagate.push_back(target_coords);
-                }
-
-                deduce_after_forbid(sudoku, target_coords, source_value, &to_propagate);
-
-                #ifndef NDEBUG
-                // All single-value deductions have been applied
-                for (const auto& cell : sudoku->cells()) {
-                  assert(cell.is_set() || cell.allowed_count() > 1);
-                }
-                // All single-place deductions have been applied
-                for (const auto& region : sudoku->regions()) {
-                  for (const unsigned value : SudokuConstants<size>::values) {
-                    unsigned count = 0;
-                    const typename Sudoku<ExplorableCell<size>, size>::Cell* single_cell = nullptr;
-                    for (const auto& cell : region.cells()) {
-                      if (cell.is_allowed(value)) {
-                        ++count;
-                        single_cell = &cell;
-                      }
-                    }
-                    assert(!(count == 1 && !single_cell->is_set()));
-                  }
-                }
-                #endif
-
-                // 'is_solved' is currently O(size^2),
-                // which we could optimize easily with additional book-keeping,
-                // but the *whole* solving algorithm still executes in less than 100ms for size 9,
-                // so it's not worth it yet.
-                if (sudoku->is_solved()) {
-                  sink_event(SudokuIsSolved<size>());
-                  // @todo return solved;
-                }
-              } else {
-                // Nothing to do: this is old news
-              }
-            }
-          }
-        }
+        PropagationStartsForCell<max_size>(source_coords, source_value),
+        PropagationIsDoneForCell<max_size>(source_coords, source_value));
+
+      if (solved) {
+        // All cells are set consistently so this propagation has no effect, but its events are still expected
+        continue;
+      }
+
+      switch (propagate_from_cell(sudoku, source_coords, source_value)) {
+        case PropagationResult::solved:
+          solved = true;
+          break;
+        case PropagationResult::unsolvable:
+          return PropagationResult::unsolvable;
+        case PropagationResult::requires_exploration:
+          break;
       }
     }
 
-    // @todo Remove the test, always return requires_exploration
     if (sudoku->is_solved()) {
       return PropagationResult::solved;
     } else {
@@ -330,63 +268,218 @@ class ExplorationSolver {
     }
   }
 
+  PropagationResult propagate_from_cell(
+    Explorable* sudoku,
+    const Coordinates& source_coords,
+    const unsigned source_value
+  ) {
+    const auto& peers = constants.peers(source_coords);
+    const auto candidates = sudoku->peers_allowing(source_coords, source_value, options.kernel);
+    for (unsigned word_index = 0; word_index != candidates.size(); ++word_index) {
+      for (uint64_t word = candidates[word_index]; word; word &= word - 1) {
+        const unsigned peer_index = word_index * 64 + std::countr_zero(word);
+        const auto& target_coords = peers[peer_index];
+        // Peers not in 'candidates' can't allow 'source_value' anymore, but the ones in 'candidates'
+        // may have changed since, because of the deductions made while propagating to previous peers
+        if (sudoku->is_set(target_coords)) {
+          if (sudoku->get(target_coords) == source_value) {
+            return PropagationResult::unsolvable;
+          }
+        } else if (sudoku->is_allowed(target_coords, source_value)) {
+          sink<CellPropagates>(source_coords, target_coords, source_value);
+          if (forbid_and_deduce(sudoku, target_coords, source_value) == PropagationResult::solved) {
+            return PropagationResult::solved;
+          }
+        } else {
+          // Nothing to do: this is old news
+        }
+      }
+    }
+
+    return PropagationResult::requires_exploration;
+  }
+
+  // Forbid a value in a cell, and apply the deductions that follow.
+  // Returns 'solved' if the Sudoku is then solved consistently, and 'requires_exploration' otherwise.
+  PropagationResult forbid_and_deduce(
+    Explorable* sudoku,
+    const Coordinates& coords,
+    const unsigned value
+  ) {
+    sudoku->forbid(coords, value);
+
+    if (sudoku->allowed_count(coords) == 1) {
+      const unsigned set_value = sudoku->get_single_allowed_value(coords);
+      sink<CellIsDeducedFromSingleAllowedValue>(coords, set_value);
+      const auto previously_allowed = sudoku->set(coords, set_value);
+      assert(previously_allowed == 0);  // No need to call 'deduce_after_set'
+
+      to_propagate.push_back(coords);
+    }
+
+    deduce_after_forbid(sudoku, coords, value);
+
+    assert_all_deductions_are_applied(*sudoku);
+
+    if (sudoku->is_solved()) {
+      sink<SudokuIsSolved>();
+      // Pending propagations can only have an effect if there is a conflict
+      if (sudoku->all_regions_are_complete()) {
+        return PropagationResult::solved;
+      }
+    }
+
+    return PropagationResult::requires_exploration;
+  }
+
   void deduce_after_set(
-    Sudoku<ExplorableCell<size>, size>* sudoku,
+    Explorable* sudoku,
     const Coordinates& coords,
-    const std::bitset<size>& previously_allowed,
-    std::deque<Coordinates>* to_propagate
+    const Mask previously_allowed
   ) {
-    auto& set_cell = sudoku->cell(coords);
-    assert(set_cell.is_set());
+    assert(sudoku->is_set(coords));
 
-    for (const unsigned value : SudokuConstants<size>::values) {
-      if (previously_allowed.test(value)) {
-        assert(value != set_cell.get());
-        deduce_after_forbid(sudoku, coords, value, to_propagate);
+    for (const unsigned value : constants.values()) {
+      if (previously_allowed & Explorable::bit(value)) {
+        assert(value != sudoku->get(coords));
+        deduce_after_forbid(sudoku, coords, value);
       }
     }
   }
 
   void deduce_after_forbid(
-    Sudoku<ExplorableCell<size>, size>* sudoku,
+    Explorable* sudoku,
     const Coordinates& coords,
-    const unsigned value,
-    std::deque<Coordinates>* to_propagate
+    const unsigned value
   ) {
-    for (auto& region : sudoku->cell(coords).regions()) {
-      unsigned count = 0;
-      typename Sudoku<ExplorableCell<size>, size>::Cell* single_cell = nullptr;
-      for (auto& cell : region.cells()) {
-        if (cell.is_allowed(value)) {
-          ++count;
-          single_cell = &cell;
+    for (const unsigned region : constants.regions_of(coords)) {
+      const Mask places = sudoku->places_in_region(region, value);
+      if (std::popcount(places) != 1) {
+        continue;
+      }
+      const auto& single_coords = constants.region(region)[std::countr_zero(places)];
+      if (!sudoku->is_set(single_coords)) {
+        sink<CellIsDeducedAsSinglePlaceForValueInRegion>(single_coords, value, region);
+        const auto previously_allowed = sudoku->set(single_coords, value);
+
+        to_propagate.push_back(single_coords);
+
+        deduce_after_set(sudoku, single_coords, previously_allowed);
+      }
+    }
+  }
+
+  void assert_all_deductions_are_applied(const Explorable& sudoku [[maybe_unused]]) {
+    #ifndef NDEBUG
+    // All single-value deductions have been applied
+    for (const auto& coords : constants.cells()) {
+      assert(sudoku.is_set(coords) || sudoku.allowed_count(coords) > 1);
+    }
+    // All single-place deductions have been applied, and places are up to date
+    for (const unsigned region : constants.region_indexes()) {
+      for (const unsigned value : constants.values()) {
+        Mask places = 0;
+        for (unsigned position = 0; position != size(); ++position) {
+          if (sudoku.is_allowed(constants.region(region)[position], value)) {
+            places |= Explorable::bit(position);
+          }
+        }
+        assert(places == sudoku.places_in_region(region, value));
+        if (std::popcount(places) == 1) {
+          assert(sudoku.is_set(constants.region(region)[std::countr_zero(places)]));
         }
       }
-      if (count == 1 && !single_cell->is_set()) {
-        const Coordinates single_coords = single_cell->coordinates();
-        sink_event(CellIsDeducedAsSinglePlaceForValueInRegion<size>(
-          single_coords, value, region.index()));
-        const auto previously_allowed = single_cell->set(value);
+    }
+    #endif
+  }
 
-        assert(std::count(to_propagate->begin(), to_propagate->end(), single_coords) == 0);
-        to_propagate->push_back(single_coords);
+  // Construct events only for sinks that actually use them
+  template<template<unsigned> typename Event, typename... Args>
+  void sink(const Args&... args) {
+    if constexpr (!is_null_event_sink<EventSink>) {
+      sink_event(Event<max_size>(args...));
+    }
+  }
+
+  enum class DeductionResult { nothing_found, progress, unsolvable };
 
-        deduce_after_set(sudoku, single_coords, previously_allowed, to_propagate);
+  DeductionResult apply_deduction_rules(Explorable* sudoku) {
+    CHRONE();
+
+    if (options.rules.naked_pairs) {
+      if (const auto deduction = find_naked_pair(*sudoku)) {
+        return apply_deduction(sudoku, *deduction);
+      }
+    }
+    if (options.rules.hidden_pairs) {
+      if (const auto deduction = find_hidden_pair(*sudoku)) {
+        return apply_deduction(sudoku, *deduction);
+      }
+    }
+    if (options.rules.pointing_pairs) {
+      if (const auto deduction = find_pointing_pair(*sudoku)) {
+        return apply_deduction(sudoku, *deduction);
+      }
+    }
+    if (options.rules.box_line_reductions) {
+      if (const auto deduction = find_box_line_reduction(*sudoku)) {
+        return apply_deduction(sudoku, *deduction);
+      }
+    }
+    if (options.rules.x_wings) {
+      if (const auto deduction = find_x_wing(*sudoku)) {
+        return apply_deduction(sudoku, *deduction);
+      }
+    }
+    return DeductionResult::nothing_found;
+  }
+
+  template<template<unsigned> typename Event>
+  DeductionResult apply_deduction(Explorable* sudoku, const Deduction<Constants, Event>& deduction) {
+    if constexpr (!is_null_event_sink<EventSink>) {
+      sink_event(deduction.event);
+    }
+
+    for (const auto& [coords, value] : deduction.eliminations) {
+      // The deductions that followed previous eliminations may have changed the cell
+      if (sudoku->is_set(coords)) {
+        if (sudoku->get(coords) == value) {
+          return DeductionResult::unsolvable;
+        }
+      } else if (sudoku->is_allowed(coords, value)) {
+        sink<ValueIsForbiddenInCell>(coords, value);
+        // If this solves the Sudoku, 'propagate' will notice it
+        forbid_and_deduce(sudoku, coords, value);
       }
     }
+
+    return DeductionResult::progress;
+  }
+
+  Coordinates get_most_constrained_cell(const Explorable& sudoku) {
+    switch (options.cell_choice) {
+      case ExplorationOptions::CellChoice::mrv:
+      case ExplorationOptions::CellChoice::region:
+        return get_first_cell_with_fewest_allowed_values(sudoku);
+      case ExplorationOptions::CellChoice::mrv_degree:
+        return get_cell_with_fewest_allowed_values_and_most_unset_peers(sudoku);
+      case ExplorationOptions::CellChoice::buckets:
+        return get_first_cell_in_smallest_bucket(sudoku);
+    }
+    __builtin_unreachable();
   }
 
-  Coordinates get_most_constrained_cell(Sudoku<ExplorableCell<size>, size>* sudoku) {
+  Coordinates get_first_cell_with_fewest_allowed_values(const Explorable& sudoku) {
     Coordinates best_coords;
-    unsigned best_count = size + 1;
+    unsigned best_count = size() + 1;
 
-    for (const auto& cell : sudoku->cells()) {
-      if (cell.is_set()) {
+    for (const auto& coords : constants.cells()) {
+      if (sudoku.is_set(coords)) {
         continue;
       }
-      unsigned count = cell.allowed_count();
+      unsigned count = sudoku.allowed_count(coords);
       if (count < best_count) {
-        best_coords = cell.coordinates();
+        best_coords = coords;
         best_count = count;
       }
       if (best_count == 2) {
@@ -397,91 +490,476 @@ class ExplorationSolver {
     return best_coords;
   }
 
-  enum class ExplorationResult { solved, unsolvable };
+  Coordinates get_cell_with_fewest_allowed_values_and_most_unset_peers(const Explorable& sudoku) {
+    Coordinates best_coords;
+    unsigned best_count = size() + 1;
+    unsigned best_unset_peers = 0;
 
-  ExplorationResult explore(Sudoku<ExplorableCell<size>, size>* sudoku) {
-    CHRONE();
+    for (const auto& coords : constants.cells()) {
+      if (sudoku.is_set(coords)) {
+        continue;
+      }
+      const unsigned count = sudoku.allowed_count(coords);
+      if (count > best_count) {
+        continue;
+      }
+      unsigned unset_peers = 0;
+      for (const auto& peer : constants.peers(coords)) {
+        if (!sudoku.is_set(peer)) {
+          ++unset_peers;
+        }
+      }
+      if (count < best_count || unset_peers > best_unset_peers) {
+        best_coords = coords;
+        best_count = count;
+        best_unset_peers = unset_peers;
+      }
+    }
 
-    assert(!sudoku->is_solved());
+    return best_coords;
+  }
 
-    const Coordinates coords = get_most_constrained_cell(sudoku);
-    const auto& cell = sudoku->cell(coords);
-    std::vector<unsigned> allowed_values;
-    for (unsigned value : SudokuConstants<size>::values) {
-      if (cell.is_allowed(value)) {
-        allowed_values.push_back(value);
+  Coordinates get_first_cell_in_smallest_bucket(const Explorable& sudoku) {
+    // All single-value deductions have been applied, so no unset cell has fewer than two allowed values
+    unsigned best_count = 2;
+    while (sudoku.unset_cells_with_allowed_count(best_count) == 0) {
+      ++best_count;
+      assert(best_count <= size());
+    }
+
+    for (const auto& coords : constants.cells()) {
+      if (!sudoku.is_set(coords) && sudoku.allowed_count(coords) == best_count) {
+        return coords;
       }
     }
+    __builtin_unreachable();
+  }
 
-    EventsPairGuard guard(
-      sink_event,
-      ExplorationStarts<size>(coords, allowed_values),
-      ExplorationIsDone<size>(coords));
+  Hypotheses get_hypotheses_on_cell(const Explorable& sudoku, const Coordinates& coords) {
+    Hypotheses hypotheses;
+    switch (options.value_order) {
+      case ExplorationOptions::ValueOrder::ascending:
+        for (const unsigned value : constants.values()) {
+          if (sudoku.is_allowed(coords, value)) {
+            hypotheses.push_back({coords, value});
+          }
+        }
+        break;
+      case ExplorationOptions::ValueOrder::least_constraining: {
+        // Pairs of (number of peers allowing the value, value), so that sorting breaks ties by ascending value
+        std::array<std::pair<unsigned, unsigned>, max_size> constrained_peers;
+        unsigned count = 0;
+        for (const unsigned value : constants.values()) {
+          if (sudoku.is_allowed(coords, value)) {
+            // Set peers don't allow 'value': they would have propagated it
+            unsigned peers = 0;
+            for (const uint64_t word : sudoku.peers_allowing(coords, value, options.kernel)) {
+              peers += std::popcount(word);
+            }
+            constrained_peers[count++] = {peers, value};
+          }
+        }
+        std::sort(constrained_peers.begin(), constrained_peers.begin() + count);
+        for (unsigned i = 0; i != count; ++i) {
+          hypotheses.push_back({coords, constrained_peers[i].second});
+        }
+        break;
+      }
+      case ExplorationOptions::ValueOrder::random: {
+        std::array<unsigned, max_size> values;
+        unsigned count = 0;
+        for (const unsigned value : constants.values()) {
+          if (sudoku.is_allowed(coords, value)) {
+            values[count++] = value;
+          }
+        }
+        std::shuffle(values.begin(), values.begin() + count, random);
+        for (unsigned i = 0; i != count; ++i) {
+          hypotheses.push_back({coords, values[i]});
+        }
+        break;
+      }
+    }
+    return hypotheses;
+  }
+
+  // The places of the value with the fewest places in a region, if there are fewer than 'max_count'
+  std::optional<Hypotheses> get_hypotheses_in_region(const Explorable& sudoku, const unsigned max_count) {
+    unsigned best_region = 0;
+    unsigned best_value = 0;
+    unsigned best_count = max_count;
+    for (const unsigned region : constants.region_indexes()) {
+      const Mask values_in_region = sudoku.values_in_region(region);
+      for (const unsigned value : constants.values()) {
+        if (values_in_region & Explorable::bit(value)) {
+          continue;
+        }
+        // All single-place deductions have been applied, so there are at least two places
+        const unsigned count = std::popcount(sudoku.places_in_region(region, value));
+        if (count < best_count) {
+          best_region = region;
+          best_value = value;
+          best_count = count;
+        }
+      }
+    }
 
-    for (unsigned value : allowed_values) {
-      sink_event(HypothesisIsMade<size>(coords, value));
-      Sudoku<ExplorableCell<size>, size> copied_sudoku(*sudoku);
-      const auto previously_allowed = copied_sudoku.cell(coords).set(value);
+    if (best_count == max_count) {
+      return std::nullopt;
+    }
 
-      std::deque<Coordinates> to_propagate(1, {coords});
-      deduce_after_set(&copied_sudoku, coords, previously_allowed, &to_propagate);
+    Hypotheses hypotheses;
+    for (Mask places = sudoku.places_in_region(best_region, best_value); places; places &= places - 1) {
+      hypotheses.push_back({constants.region(best_region)[std::countr_zero(places)], best_value});
+    }
+    return hypotheses;
+  }
 
-      if (copied_sudoku.is_solved()) {
-        sink_event(SudokuIsSolved<size>());
+  // The hypotheses of a new level of the search, following 'options.cell_choice' and 'options.value_order'.
+  // Sets '*on_cell' if they are all on the same cell.
+  Hypotheses get_hypotheses(const Explorable& sudoku, bool* on_cell) {
+    const Coordinates coords = get_most_constrained_cell(sudoku);
+    if (options.cell_choice == ExplorationOptions::CellChoice::region) {
+      if (const auto region_hypotheses = get_hypotheses_in_region(sudoku, sudoku.allowed_count(coords))) {
+        *on_cell = false;
+        return *region_hypotheses;
       }
+    }
+    *on_cell = true;
+    return get_hypotheses_on_cell(sudoku, coords);
+  }
 
-      switch (propagate_and_explore(&copied_sudoku, std::move(to_propagate))) {
-        case ExplorationResult::solved:
-          sink_event(HypothesisIsAccepted<size>(coords, value));
-          *sudoku = copied_sudoku;
-          return ExplorationResult::solved;
-        case ExplorationResult::unsolvable:
-          sink_event(HypothesisIsRejected<size>(coords, value));
+  // Propagation, then deduction rules, until they can't go further
+  PropagationResult propagate_and_deduce(Explorable* sudoku) {
+    while (true) {
+      switch (propagate(sudoku)) {
+        case PropagationResult::solved:
+          return PropagationResult::solved;
+        case PropagationResult::unsolvable:
+          return PropagationResult::unsolvable;
+        case PropagationResult::requires_exploration:
           break;
       }
-    }
 
-    return ExplorationResult::unsolvable;
+      switch (apply_deduction_rules(sudoku)) {
+        case DeductionResult::nothing_found:
+          return PropagationResult::requires_exploration;
+        case DeductionResult::unsolvable:
+          return PropagationResult::unsolvable;
+        case DeductionResult::progress:
+          // Propagate the cells set by the deduction, then try the rules again
+          break;
+      }
+    }
   }
 
-  ExplorationResult propagate_and_explore(Sudoku<ExplorableCell<size>, size>* sudoku, std::deque<Coordinates>&& todo) {
+  // 'stopped' when cancelled or out of budget, before finding out
+  enum class ExplorationResult { solved, unsolvable, stopped };
+
+  // A level of the search: hypotheses of which one must be true, and how to undo the rejected ones
+  struct Frame {
+    Hypotheses hypotheses;
+    unsigned next_hypothesis;
+    // Hypotheses on a single cell are surrounded by 'ExplorationStarts' and 'ExplorationIsDone' events
+    bool on_cell;
+    // Undo by restoring the last element of 'copies', or else by undoing the trail down to 'trail_size'
+    bool copied;
+    unsigned trail_size;
+  };
+
+  // With 'copy' backtracking, the first levels each keep a copy of the Sudoku, and deeper levels, if any,
+  // record their changes on the trail, to bound the size of the solver
+  static constexpr unsigned max_copied_levels =
+    std::min(max_size * max_size, (256 * 1024) / Explorable::footprint(max_size));
+
+  // Propagation and deductions, then hypotheses, recursively until one of them leads to a solution
+  // or all of them are rejected. The levels of hypotheses are on the explicit stack 'frames' instead of the
+  // call stack, and '*sudoku' is always the state of the deepest one.
+  ExplorationResult propagate_and_explore(Explorable* sudoku) {
     CHRONE();
 
-    switch (propagate(sudoku, std::move(todo))) {
+    assert(frames.empty());
+    // The result of the last hypothesis, or 'std::nullopt' if it required a new level
+    std::optional<ExplorationResult> result = propagate_and_push_frame(sudoku);
+    while (!frames.empty()) {
+      Frame& frame = frames.back();
+
+      if (result) {
+        const auto& [coords, value] = frame.hypotheses[frame.next_hypothesis - 1];
+        switch (*result) {
+          case ExplorationResult::solved:
+            sink<HypothesisIsAccepted>(coords, value);
+            pop_frame();
+            continue;
+          case ExplorationResult::unsolvable:
+            sink<HypothesisIsRejected>(coords, value);
+            restore(sudoku, frame);
+            break;
+          case ExplorationResult::stopped:
+            pop_frame();
+            continue;
+        }
+      }
+
+      if (frame.next_hypothesis == frame.hypotheses.size()) {
+        pop_frame();
+        result = ExplorationResult::unsolvable;
+        continue;
+      }
+
+      if (
+        (options.cancellation && options.cancellation->is_cancelled())
+        || (options.budget && !options.budget->spend_hypothesis())
+      ) {
+        pop_frame();
+        result = ExplorationResult::stopped;
+        continue;
+      }
+
+      const auto [coords, value] = frame.hypotheses[frame.next_hypothesis++];
+      make_hypothesis(sudoku, coords, value);
+      result = propagate_and_push_frame(sudoku);
+    }
+
+    assert(result);
+    return *result;
+  }
+
+  std::optional<ExplorationResult> propagate_and_push_frame(Explorable* sudoku) {
+    switch (propagate_and_deduce(sudoku)) {
       case PropagationResult::solved:
+        if (counting) {
+          // Reject this solution like an unsolvable hypothesis, to keep exploring, until the limit
+          ++solutions_count;
+          if (!solutions_limit || solutions_count < *solutions_limit) {
+            return ExplorationResult::unsolvable;
+          }
+        }
         return ExplorationResult::solved;
       case PropagationResult::unsolvable:
         return ExplorationResult::unsolvable;
       case PropagationResult::requires_exploration:
-        return explore(sudoku);
+        push_frame(sudoku);
+        return std::nullopt;
     }
     __builtin_unreachable();
   }
 
+  void push_frame(Explorable* sudoku) {
+    assert(!sudoku->is_solved());
+
+    Frame frame;
+    frame.next_hypothesis = 0;
+
+    frame.hypotheses = get_hypotheses(*sudoku, &frame.on_cell);
+    if (frame.on_cell) {
+      const Coordinates& coords = frame.hypotheses[0].first;
+      sink<ExplorationStarts>(coords, sudoku->allowed(coords));
+    }
+
+    frame.copied = options.backtracking == ExplorationOptions::Backtracking::copy && copied_count != copied_levels;
+    if (frame.copied) {
+      copies[copied_count++] = *sudoku;
+    } else {
+      // No-op with 'undo_trail' backtracking, where all changes are already recorded
+      sudoku->record_changes_on(&trail);
+    }
+    frame.trail_size = trail.size();
+
+    frames.push_back(frame);
+  }
+
+  void pop_frame() {
+    const Frame& frame = frames.back();
+    if (frame.on_cell) {
+      sink<ExplorationIsDone>(frame.hypotheses[0].first);
+    }
+    if (frame.copied) {
+      --copied_count;
+    }
+    frames.pop_back();
+  }
+
+  void make_hypothesis(Explorable* sudoku, const Coordinates& coords, const unsigned value) {
+    sink<HypothesisIsMade>(coords, value);
+    ++hypotheses_count;
+    const auto previously_allowed = sudoku->set(coords, value);
+
+    // The queue may not be empty if the previous hypothesis was rejected during propagation
+    to_propagate.clear();
+    to_propagate.push_back(coords);
+    deduce_after_set(sudoku, coords, previously_allowed);
+
+    if (sudoku->is_solved()) {
+      sink<SudokuIsSolved>();
+    }
+  }
+
+  // Come back to the state before the last hypothesis of 'frame'
+  void restore(Explorable* sudoku, const Frame& frame) {
+    if (frame.copied) {
+      // The copy was made before deeper levels, if any, started recording changes: they are all discarded
+      *sudoku = *copies[copied_count - 1];
+      trail.clear();
+    } else {
+      sudoku->undo_changes(frame.trail_size);
+    }
+  }
+
  private:
-  Sudoku<ValueCell, size> input_sudoku;
+  // Empty for 'CompileTimeConstants'
+  [[no_unique_address]] Constants constants;
   EventSink& sink_event;
+  ExplorationOptions options;
+  // For 'ValueOrder::random'
+  std::minstd_rand random;
+  typename Constants::template Vector<Input, max_size * max_size> inputs;
+  // The state of the deepest level of the search
+  Explorable explored_sudoku;
+  // Shared by all hypotheses: each one is fully propagated before the next one is made
+  PropagationQueue<Constants> to_propagate;
+  typename Explorable::Trail trail;
+  typename Constants::template Vector<Frame, max_size * max_size> frames;
+  const unsigned copied_levels;
+  // Optional to avoid constructing all the Sudokus with the solver
+  typename Constants::template Array<std::optional<Explorable>, max_copied_levels> copies;
+  unsigned copied_count;
+  // For 'count'
+  bool counting;
+  std::optional<unsigned> solutions_limit;
+  unsigned solutions_count;
+  unsigned hypotheses_count;
 };
 
+template<unsigned size, typename EventSink>
+using ExplorationSolver = BasicExplorationSolver<CompileTimeConstants<size>, EventSink>;
+
+// Compiled once for all sizes with the same masks, in 'sudoku-solver.cpp'
+template<typename Mask>
+using RuntimeExplorationSolver = BasicExplorationSolver<RuntimeConstants<Mask>, const NullEventSink>;
+
+extern template class BasicExplorationSolver<RuntimeConstants<uint16_t>, const NullEventSink>;
+extern template class BasicExplorationSolver<RuntimeConstants<uint32_t>, const NullEventSink>;
+extern template class BasicExplorationSolver<RuntimeConstants<uint64_t>, const NullEventSink>;
+
+// The solver of this size for the calling thread, reset with these options and without inputs.
+// It's built on first use, with all the memory exploration may need, so that it then doesn't allocate.
+template<typename Mask>
+RuntimeExplorationSolver<Mask>& get_runtime_exploration_solver(unsigned size, const ExplorationOptions& options);
+
+// 'ExplorationSolver' is compiled for 9x9 Sudokus, the most common ones, and for all sizes when events are needed.
+// Other sizes are solved without events by 'RuntimeExplorationSolver', compiled once for all sizes with the same masks.
+template<unsigned size>
+constexpr bool has_compiled_exploration = size == 9;
+
+template<unsigned size, typename Solver>
+void set_exploration_inputs(const Sudoku<ValueCell, size>& sudoku, Solver* solver) {
+  for (const auto& cell : sudoku.cells()) {
+    const auto value = cell.get();
+    if (value) {
+      solver->set_input(cell.coordinates(), *value);
+    }
+  }
+}
+
+// The trail and the frames grow with the cube of the size: from size 36, the solver doesn't fit on the stack.
+// Smaller solvers stay on the stack, to keep exploration free of heap allocations.
+template<unsigned size, typename EventSink, typename F>
+auto with_exploration_solver(
+  const Sudoku<ValueCell, size>& sudoku,
+  EventSink& sink_event,
+  const ExplorationOptions& options,
+  const F& f
+) {
+  if constexpr (!has_compiled_exploration<size> && is_null_event_sink<EventSink>) {
+    auto& solver = get_runtime_exploration_solver<ValuesMask<size>>(size, options);
+    set_exploration_inputs(sudoku, &solver);
+    return f(solver);
+  } else if constexpr (sizeof(ExplorationSolver<size, EventSink>) <= 1024 * 1024) {
+    ExplorationSolver<size, EventSink> solver(CompileTimeConstants<size>(), sink_event, options);
+    set_exploration_inputs(sudoku, &solver);
+    return f(solver);
+  } else {
+    const auto solver = std::make_unique<ExplorationSolver<size, EventSink>>(
+      CompileTimeConstants<size>(), sink_event, options);
+    set_exploration_inputs(sudoku, solver.get());
+    return f(*solver);
+  }
+}
+
+// Solve, and return the solution as a 'Sudoku'
+template<unsigned size, typename Solver>
+std::optional<Sudoku<ValueCell, size>> get_exploration_solution(Solver* solver) {
+  std::optional<Sudoku<ValueCell, size>> solved;
+  if (solver->solve()) {
+    solved.emplace();
+    for (const auto& coords : SudokuConstants<size>::cells) {
+      solved->cell(coords).set(solver->get_sudoku().get(coords));
+    }
+  }
+  return solved;
+}
+
 template<unsigned size, typename EventSink>
 std::optional<Sudoku<ValueCell, size>> solve_using_exploration(
   Sudoku<ValueCell, size> sudoku,
-  EventSink& sink_event
+  EventSink& sink_event,
+  const ExplorationOptions& options = {}
 ) {
-  return ExplorationSolver(sudoku, sink_event).solve();
+  return with_exploration_solver(sudoku, sink_event, options, [](auto& solver) {
+    return get_exploration_solution<size>(&solver);
+  });
 }
 
 template<unsigned size, typename EventSink>
 std::optional<Sudoku<ValueCell, size>> solve_using_exploration(
   Sudoku<ValueCell, size> sudoku,
-  const EventSink& sink_event
+  const EventSink& sink_event,
+  const ExplorationOptions& options = {}
 ) {
-  return ExplorationSolver(sudoku, sink_event).solve();
+  return with_exploration_solver(sudoku, sink_event, options, [](auto& solver) {
+    return get_exploration_solution<size>(&solver);
+  });
 }
 
 template<unsigned size>
 std::optional<Sudoku<ValueCell, size>> solve_using_exploration(Sudoku<ValueCell, size> sudoku) {
-  return solve_using_exploration(sudoku, [](const auto&) {});
+  return solve_using_exploration(sudoku, NullEventSink());
+}
+
+template<unsigned size>
+unsigned count_solutions_using_exploration(
+  Sudoku<ValueCell, size> sudoku,
+  const std::optional<unsigned> limit,
+  const ExplorationOptions& options = {}
+) {
+  const NullEventSink sink_event;
+  return with_exploration_solver(sudoku, sink_event, options, [&](auto& solver) { return solver.count(limit); });
+}
+
+// The number of hypotheses made to solve the Sudoku, to compare exploration settings
+template<unsigned size>
+unsigned count_hypotheses_using_exploration(Sudoku<ValueCell, size> sudoku, const ExplorationOptions& options = {}) {
+  const NullEventSink sink_event;
+  return with_exploration_solver(sudoku, sink_event, options, [](auto& solver) {
+    solver.solve();
+    return solver.get_hypotheses_count();
+  });
+}
+
+// The deductions of exploration (propagation, and the rules in 'options'), without hypotheses.
+// Returns an 'ExplorableSudoku<size>' or a 'RuntimeExplorableSudoku<ValuesMask<size>>', which have the same interface.
+template<unsigned size>
+auto deduce_using_exploration(Sudoku<ValueCell, size> sudoku, const ExplorationOptions& options = {}) {
+  const NullEventSink sink_event;
+  return with_exploration_solver(sudoku, sink_event, options, [](auto& solver) {
+    typedef std::remove_cvref_t<decltype(solver.get_sudoku())> Explorable;
+    if (solver.deduce()) {
+      return std::optional<Explorable>(solver.get_sudoku());
+    } else {
+      return std::optional<Explorable>();
+    }
+  });
 }
 
 #endif  // EXPLORATION_SUDOKU_SOLVER_HPP_
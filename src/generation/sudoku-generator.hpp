@@ -0,0 +1,121 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef GENERATION_SUDOKU_GENERATOR_HPP_
+#define GENERATION_SUDOKU_GENERATOR_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <chrones.hpp>
+
+#include "../exploration/sudoku-solver.hpp"
+#include "../parallel/work-stealing-pool.hpp"
+#include "../puzzle/sudoku.hpp"
+
+
+// Generates Sudokus with a unique solution, and no clue that can be removed without losing this uniqueness.
+// A random solved Sudoku is produced by exploring an empty one with shuffled values. Then its clues are tried
+// for removal in random order, each one kept only if exploration finds a second solution without it.
+// The same seed generates the same Sudokus, whatever the number of threads.
+template<unsigned size>
+class SudokuGenerator {
+ public:
+  SudokuGenerator(const uint64_t seed, const unsigned jobs) : random(seed), pool(jobs) {}
+
+ public:
+  Sudoku<ValueCell, size> generate() {
+    CHRONE();
+
+    const Sudoku<ValueCell, size> solution = generate_solution();
+
+    std::vector<unsigned> candidates(size * size);
+    for (unsigned index = 0; index != size * size; ++index) {
+      candidates[index] = index;
+    }
+    std::shuffle(candidates.begin(), candidates.end(), random);
+
+    std::array<bool, size * size> clues;
+    clues.fill(true);
+    remove_clues(solution, candidates, &clues);
+
+    return make_puzzle(solution, clues);
+  }
+
+ private:
+  Sudoku<ValueCell, size> generate_solution() {
+    CHRONE();
+
+    ExplorationOptions options;
+    options.value_order = ExplorationOptions::ValueOrder::random;
+    options.random_seed = uint32_t(random());
+    const auto solution = solve_using_exploration(Sudoku<ValueCell, size>(), NullEventSink(), options);
+    assert(solution);
+    return *solution;
+  }
+
+  // Removing clues only adds solutions, so a clue that can't be removed now can't be removed later either.
+  // This lets the threads each try a candidate on the same Sudoku: candidates that can't be removed are rejected
+  // for good, the first one (in order) that can be removed is removed, and the next ones that could be removed are
+  // tried again without it. This removes exactly the same clues as trying the candidates one after the other.
+  void remove_clues(
+    const Sudoku<ValueCell, size>& solution,
+    const std::vector<unsigned>& candidates,
+    std::array<bool, size * size>* clues
+  ) {
+    CHRONE();
+
+    std::vector<unsigned> pending(candidates.rbegin(), candidates.rend());
+    std::vector<unsigned char> removable(pool.workers_count());
+    while (!pending.empty()) {
+      const unsigned batch_size = std::min<unsigned>(pending.size(), pool.workers_count());
+      for (unsigned i = 0; i != batch_size; ++i) {
+        const unsigned candidate = pending[pending.size() - 1 - i];
+        pool.submit([this, &solution, clues, &removable, candidate, i](unsigned) {
+          std::array<bool, size * size> tried_clues = *clues;
+          tried_clues[candidate] = false;
+          removable[i] = count_solutions_using_exploration(make_puzzle(solution, tried_clues), 2) == 1;
+        });
+      }
+      pool.wait();
+
+      std::vector<unsigned> retried;
+      bool removed = false;
+      for (unsigned i = 0; i != batch_size; ++i) {
+        const unsigned candidate = pending.back();
+        pending.pop_back();
+        if (!removable[i]) {
+          continue;
+        } else if (!removed) {
+          (*clues)[candidate] = false;
+          removed = true;
+        } else {
+          retried.push_back(candidate);
+        }
+      }
+      pending.insert(pending.end(), retried.rbegin(), retried.rend());
+    }
+  }
+
+  static Sudoku<ValueCell, size> make_puzzle(
+    const Sudoku<ValueCell, size>& solution,
+    const std::array<bool, size * size>& clues
+  ) {
+    Sudoku<ValueCell, size> puzzle;
+    for (const auto& [row, col] : SudokuConstants<size>::cells) {
+      if (clues[row * size + col]) {
+        puzzle.cell({row, col}).set(*solution.cell({row, col}).get());
+      }
+    }
+    return puzzle;
+  }
+
+ private:
+  std::mt19937_64 random;
+  WorkStealingPool pool;
+};
+
+#endif  // GENERATION_SUDOKU_GENERATOR_HPP_
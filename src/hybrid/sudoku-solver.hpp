@@ -0,0 +1,47 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef HYBRID_SUDOKU_SOLVER_HPP_
+#define HYBRID_SUDOKU_SOLVER_HPP_
+
+#include <optional>
+
+#include <chrones.hpp>
+
+#include "../exploration/sudoku-solver.hpp"
+#include "../puzzle/sudoku.hpp"
+#include "../sat/sudoku-solver.hpp"
+
+
+// Applies the cheap deductions of exploration first, then gives only the remaining candidates to the SAT solver.
+// Most Sudokus are solved by the deductions alone, or leave a tiny formula.
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> solve_using_hybrid(
+  Sudoku<ValueCell, size> sudoku,
+  const ExplorationOptions& exploration_options = {},
+  const SatOptions& sat_options = {}
+) {
+  CHRONE();
+
+  const auto deduced = deduce_using_exploration(sudoku, exploration_options);
+  if (!deduced) {
+    return std::nullopt;
+  }
+
+  SatCandidates candidates(size * size);
+  for (const auto& coords : SudokuConstants<size>::cells) {
+    const auto [row, col] = coords;
+    if (deduced->is_set(coords)) {
+      sudoku.cell(coords).set(deduced->get(coords));
+    } else {
+      candidates[row * size + col] = deduced->allowed(coords);
+    }
+  }
+
+  if (deduced->is_solved()) {
+    return sudoku;
+  } else {
+    return solve_using_sat<size>(sudoku, candidates, sat_options);
+  }
+}
+
+#endif  // HYBRID_SUDOKU_SOLVER_HPP_
@@ -0,0 +1,5 @@
+// Copyright 2023 Vincent Jacques
+
+#include "main.impl.hpp"
+
+template int main_<49>(const Options& options);
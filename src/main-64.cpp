@@ -0,0 +1,5 @@
+// Copyright 2023 Vincent Jacques
+
+#include "main.impl.hpp"
+
+template int main_<64>(const Options& options);
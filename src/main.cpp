@@ -3,6 +3,7 @@
 #include "main.hpp"
 
 #include <string>
+#include <vector>
 
 #include <chrones.hpp>
 #include <CLI11.hpp>
@@ -56,9 +57,91 @@ int main(int argc, char* argv[]) {
   CLI::App* solve = app.add_subcommand("solve", "Just solve a Sudoku");
   CLI::App* explain = app.add_subcommand("explain", "Explain how to solve a Sudoku");
   CLI::App* benchmark = app.add_subcommand("benchmark", "Benchmark the Sudoku solvers");
+  CLI::App* generate = app.add_subcommand("generate", "Generate Sudokus with a unique solution and minimal clues");
+
+  std::string engine = "exploration";
+  solve->add_option("--engine", engine,
+    "Algorithm used to solve: exploration (the default), sat (the 'Minisat' SAT solver), dlx (Dancing Links), "
+    "hybrid (exploration's deductions, then SAT on the remaining candidates), "
+    "or portfolio (exploration and SAT racing on two threads)")
+    ->check(CLI::IsMember({"exploration", "sat", "dlx", "hybrid", "portfolio"}))
+    ->option_text("ENGINE");
 
   bool use_sat = false;
-  solve->add_flag("--sat", use_sat, "Use the 'Minisat' SAT solver instead of the default exploration algorithm");
+  solve->add_flag("--sat", use_sat, "Same as --engine sat");
+
+  std::string sat_encoding = "pairwise";
+  solve->add_option("--sat-encoding", sat_encoding,
+    "With SAT, encoding of 'at most one' constraints: pairwise (the default), sequential-counter, commander, "
+    "or product")
+    ->check(CLI::IsMember({"pairwise", "sequential-counter", "commander", "product"}))
+    ->option_text("ENCODING");
+
+  bool pre_eliminate = false;
+  solve->add_flag("--pre-eliminate", pre_eliminate,
+    "With SAT, encode only the values not excluded by the givens, in a new formula for each Sudoku");
+
+  bool batch = false;
+  solve->add_flag("--batch", batch, "Solve all the Sudokus in INPUT, one after the other");
+
+  unsigned jobs = 1;
+  solve->add_option("--jobs", jobs,
+    "Number of threads (0 for one per core): with --batch, to solve several Sudokus in parallel, "
+    "otherwise, with exploration, to make hypotheses in parallel")
+    ->default_val("1");
+
+  bool compact = false;
+  solve->add_flag("--compact", compact, "Read and write Sudokus on single lines, row after row");
+
+  bool use_trail = false;
+  solve->add_flag("--trail", use_trail,
+    "With exploration, undo rejected hypotheses using a trail of changes instead of copying the Sudoku");
+
+  std::vector<std::string> rules;
+  solve->add_option("--rules", rules,
+    "With exploration, deductions tried before making hypotheses, among: "
+    "naked-pairs, hidden-pairs, pointing-pairs, box-line-reductions, x-wings")
+    ->delimiter(',')
+    ->check(CLI::IsMember({"naked-pairs", "hidden-pairs", "pointing-pairs", "box-line-reductions", "x-wings"}))
+    ->option_text("RULE,...");
+
+  std::string cell_choice = "mrv";
+  solve->add_option("--cell-choice", cell_choice,
+    "With exploration, where to make hypotheses: mrv (the default, the first cell with the fewest allowed values), "
+    "mrv-degree (same, with the most unset peers), buckets (same as mrv, found faster), "
+    "or region (the places of a value in a region, when they are fewer)")
+    ->check(CLI::IsMember({"mrv", "mrv-degree", "buckets", "region"}))
+    ->option_text("HEURISTIC");
+
+  std::string value_order = "ascending";
+  solve->add_option("--value-order", value_order,
+    "With exploration, in which order to try values: ascending (the default), "
+    "or least-constraining (values allowed by the fewest peers first)")
+    ->check(CLI::IsMember({"ascending", "least-constraining"}))
+    ->option_text("ORDER");
+
+  std::optional<double> time_limit;
+  solve->add_option("--time-limit", time_limit,
+    "Give up solving a Sudoku after this many seconds, with exit code 2 (not supported by dlx)")
+    ->check(CLI::PositiveNumber)
+    ->option_text("SECONDS");
+
+  std::optional<uint64_t> max_hypotheses;
+  solve->add_option("--max-hypotheses", max_hypotheses,
+    "With exploration, give up solving a Sudoku after this many hypotheses, with exit code 2")
+    ->option_text("N");
+
+  std::optional<uint64_t> max_conflicts;
+  solve->add_option("--max-conflicts", max_conflicts,
+    "With SAT, give up solving a Sudoku after this many conflicts, with exit code 2")
+    ->option_text("N");
+
+  bool count = false;
+  solve->add_flag("--count", count, "Output the number of solutions instead of a solution (always using exploration)");
+
+  std::optional<unsigned> limit;
+  solve->add_option("--limit", limit, "With --count, stop counting at this number of solutions (2 to check uniqueness)")
+    ->option_text("N");
 
   std::optional<std::filesystem::path> text_path;
   explain
@@ -88,6 +171,19 @@ int main(int argc, char* argv[]) {
   explain->add_option("--height", height, "Height of the images in the HTML and video explanations")
     ->default_val("480");
 
+  std::optional<uint64_t> seed;
+  generate->add_option("--seed", seed, "Seed of the random generator, to generate the same Sudokus again")
+    ->option_text("N");
+
+  unsigned puzzles = 1;
+  generate->add_option("--puzzles", puzzles, "Number of Sudokus to generate")
+    ->default_val("1");
+
+  generate->add_option("--jobs", jobs, "Number of threads (0 for one per core) trying to remove clues in parallel")
+    ->default_val("1");
+
+  generate->add_flag("--compact", compact, "Write Sudokus on single lines, row after row");
+
   std::filesystem::path input_path;
   for (auto* subcommand : {solve, explain, benchmark}) {
     subcommand
@@ -104,7 +200,26 @@ int main(int argc, char* argv[]) {
 
   Options options {
     .solve = solve->parsed(),
-    .use_sat = use_sat,
+    .engine =
+      use_sat || engine == "sat" ? Engine::sat
+      : engine == "dlx" ? Engine::dlx
+      : engine == "hybrid" ? Engine::hybrid
+      : engine == "portfolio" ? Engine::portfolio
+      : Engine::exploration,
+    .sat_encoding = sat_encoding,
+    .pre_eliminate = pre_eliminate,
+    .batch = batch,
+    .jobs = jobs,
+    .compact = compact,
+    .use_trail = use_trail,
+    .rules = rules,
+    .cell_choice = cell_choice,
+    .value_order = value_order,
+    .time_limit = time_limit,
+    .max_hypotheses = max_hypotheses,
+    .max_conflicts = max_conflicts,
+    .count = count,
+    .limit = limit,
     .explain = explain->parsed(),
     .input_path = input_path,
     .text_path = text_path,
@@ -114,6 +229,9 @@ int main(int argc, char* argv[]) {
     .width = width,
     .height = height,
     .benchmark = benchmark->parsed(),
+    .generate = generate->parsed(),
+    .seed = seed,
+    .puzzles = puzzles,
   };
 
   switch (size) {
@@ -125,6 +243,12 @@ int main(int argc, char* argv[]) {
       return main_<16>(options);
     case 25:
       return main_<25>(options);
+    case 36:
+      return main_<36>(options);
+    case 49:
+      return main_<49>(options);
+    case 64:
+      return main_<64>(options);
     default:
       std::cerr << "ERROR: unsupported size: " << size << std::endl;
       return 1;
@@ -3,13 +3,38 @@
 #ifndef MAIN_HPP_
 #define MAIN_HPP_
 
+#include <cstdint>
 #include <filesystem>
 #include <optional>
+#include <string>
+#include <vector>
 
 
+enum class Engine {
+  exploration,
+  sat,
+  dlx,
+  hybrid,
+  portfolio,
+};
+
 struct Options {
   bool solve;
-  bool use_sat;
+  Engine engine;
+  std::string sat_encoding;
+  bool pre_eliminate;
+  bool batch;
+  unsigned jobs;
+  bool compact;
+  bool use_trail;
+  std::vector<std::string> rules;
+  std::string cell_choice;
+  std::string value_order;
+  std::optional<double> time_limit;
+  std::optional<uint64_t> max_hypotheses;
+  std::optional<uint64_t> max_conflicts;
+  bool count;
+  std::optional<unsigned> limit;
 
   bool explain;
   std::filesystem::path input_path;
@@ -21,6 +46,10 @@ struct Options {
   unsigned height;
 
   bool benchmark;
+
+  bool generate;
+  std::optional<uint64_t> seed;
+  unsigned puzzles;
 };
 
 template<unsigned size>
@@ -5,106 +5,591 @@
 
 #include "main.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <iostream>
 #include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <chrones.hpp>
+
+#include "benchmark/allocation-counter.hpp"
+#include "dlx/sudoku-solver.hpp"
 #include "explanation/explanation.hpp"
 #include "explanation/html-explainer.hpp"
 #include "explanation/text-explainer.hpp"
 #include "explanation/video/frames-serializer.hpp"
 #include "explanation/video-explainer.hpp"
 #include "explanation/video/video-serializer.hpp"
+#include "generation/sudoku-generator.hpp"
+#include "exploration/parallel-sudoku-solver.hpp"
 #include "exploration/sudoku-solver.hpp"
+#include "hybrid/sudoku-solver.hpp"
+#include "parallel/reorder-buffer.hpp"
+#include "parallel/work-stealing-pool.hpp"
+#include "portfolio/sudoku-solver.hpp"
+#include "puzzle/budget.hpp"
+#include "puzzle/mapped-input.hpp"
 #include "puzzle/check.hpp"
 #include "sat/sudoku-solver.hpp"
 
 
+inline ExplorationOptions make_exploration_options(const Options& options) {
+  ExplorationOptions exploration_options;
+  if (options.use_trail) {
+    exploration_options.backtracking = ExplorationOptions::Backtracking::undo_trail;
+  }
+  for (const std::string& rule : options.rules) {
+    if (rule == "naked-pairs") {
+      exploration_options.rules.naked_pairs = true;
+    } else if (rule == "hidden-pairs") {
+      exploration_options.rules.hidden_pairs = true;
+    } else if (rule == "pointing-pairs") {
+      exploration_options.rules.pointing_pairs = true;
+    } else if (rule == "box-line-reductions") {
+      exploration_options.rules.box_line_reductions = true;
+    } else {
+      assert(rule == "x-wings");
+      exploration_options.rules.x_wings = true;
+    }
+  }
+  if (options.cell_choice == "mrv-degree") {
+    exploration_options.cell_choice = ExplorationOptions::CellChoice::mrv_degree;
+  } else if (options.cell_choice == "buckets") {
+    exploration_options.cell_choice = ExplorationOptions::CellChoice::buckets;
+  } else if (options.cell_choice == "region") {
+    exploration_options.cell_choice = ExplorationOptions::CellChoice::region;
+  } else {
+    assert(options.cell_choice == "mrv");
+  }
+  if (options.value_order == "least-constraining") {
+    exploration_options.value_order = ExplorationOptions::ValueOrder::least_constraining;
+  } else {
+    assert(options.value_order == "ascending");
+  }
+  return exploration_options;
+}
+
+inline SatOptions make_sat_options(const Options& options) {
+  SatOptions sat_options;
+  if (options.sat_encoding == "sequential-counter") {
+    sat_options.encoding = SatOptions::Encoding::sequential_counter;
+  } else if (options.sat_encoding == "commander") {
+    sat_options.encoding = SatOptions::Encoding::commander;
+  } else if (options.sat_encoding == "product") {
+    sat_options.encoding = SatOptions::Encoding::product;
+  } else {
+    assert(options.sat_encoding == "pairwise");
+  }
+  sat_options.pre_eliminate = options.pre_eliminate;
+  return sat_options;
+}
+
+inline unsigned jobs_count(const Options& options) {
+  return options.jobs == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.jobs;
+}
+
+inline Budget::Limits make_budget_limits(const Options& options) {
+  Budget::Limits limits;
+  if (options.time_limit) {
+    limits.time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(*options.time_limit));
+  }
+  limits.hypotheses = options.max_hypotheses;
+  limits.conflicts = options.max_conflicts;
+  return limits;
+}
+
+inline const char* engine_name(const Engine engine) {
+  switch (engine) {
+    case Engine::exploration:
+      return "exploration";
+    case Engine::sat:
+      return "SAT";
+    case Engine::dlx:
+      return "DLX";
+    case Engine::hybrid:
+      return "hybrid";
+    case Engine::portfolio:
+      return "portfolio";
+  }
+  __builtin_unreachable();
+}
+
+// Solves Sudokus using the engine chosen in the options, for the 'solve' command.
+// With 'solve --batch', each worker has its own, so that nothing is shared between workers while solving.
 template<unsigned size>
-int main_(const Options& options) {
-  const auto sudoku = ([&options](){
-    if (options.input_path == "-") {
-      return Sudoku<ValueCell, size>::load(std::cin);
+class Solver {
+ public:
+  explicit Solver(const Options& options) :
+    engine(options.engine),
+    // With --batch, threads solve different Sudokus
+    exploration_jobs(options.batch ? 1 : jobs_count(options)),
+    exploration_options(make_exploration_options(options)),
+    sat_options(make_sat_options(options)),
+    limits(make_budget_limits(options)),
+    solutions_limit(options.limit),
+    gave_up_(false),
+    portfolio_exploration_worker(engine == Engine::portfolio ? std::make_unique<WorkStealingPool>(1) : nullptr)
+  {}
+
+ public:
+  std::optional<Sudoku<ValueCell, size>> operator()(const Sudoku<ValueCell, size>& sudoku) {
+    std::optional<Budget> budget = make_budget();
+    const auto solved = solve(sudoku, budget ? &*budget : nullptr);
+    gave_up_ = budget && budget->gave_up();
+    return solved;
+  }
+
+  // Counts solutions using exploration, whatever the engine, up to the limit in the options
+  unsigned count(const Sudoku<ValueCell, size>& sudoku) {
+    std::optional<Budget> budget = make_budget();
+    ExplorationOptions budgeted_exploration_options = exploration_options;
+    budgeted_exploration_options.budget = budget ? &*budget : nullptr;
+    const unsigned solutions_count = count_solutions_using_exploration(
+      sudoku, solutions_limit, budgeted_exploration_options);
+    gave_up_ = budget && budget->gave_up();
+    return solutions_count;
+  }
+
+  // Whether the last Sudoku was not solved (or its solutions not all counted) because of the limits in the options,
+  // rather than proven unsolvable
+  bool gave_up() const { return gave_up_; }
+
+ private:
+  // A new budget for each Sudoku. Built in place, because budgets can't be moved.
+  std::optional<Budget> make_budget() const {
+    if (limits.time || limits.hypotheses || limits.conflicts) {
+      return std::optional<Budget>(std::in_place, limits);
     } else {
-      // Race condition: the input file could have been deleted since 'CLI11_PARSE' checked. Risk accepted.
-      std::ifstream input(options.input_path);
-      assert(input.is_open());
-      return Sudoku<ValueCell, size>::load(input);
+      return std::nullopt;
     }
-  })();
+  }
 
-  if (options.solve) {
-    if (options.use_sat) {
-      const auto solved = solve_using_sat(sudoku);
+  std::optional<Sudoku<ValueCell, size>> solve(const Sudoku<ValueCell, size>& sudoku, Budget* budget) const {
+    ExplorationOptions budgeted_exploration_options = exploration_options;
+    budgeted_exploration_options.budget = budget;
+    SatOptions budgeted_sat_options = sat_options;
+    budgeted_sat_options.budget = budget;
 
-      if (solved) {
-        solved->dump(std::cout);
-        return 0;
-      } else {
-        std::cerr << "FAILED to solve this Sudoku using SAT" << std::endl;
-        return 1;
-      }
+    switch (engine) {
+      case Engine::exploration:
+        if (exploration_jobs > 1) {
+          return solve_using_parallel_exploration(sudoku, exploration_jobs, budgeted_exploration_options);
+        } else {
+          return solve_using_exploration(sudoku, NullEventSink(), budgeted_exploration_options);
+        }
+      case Engine::sat:
+        return solve_using_sat(sudoku, budgeted_sat_options);
+      case Engine::dlx:
+        // Not budgeted
+        return solve_using_dlx(sudoku);
+      case Engine::hybrid:
+        return solve_using_hybrid(sudoku, budgeted_exploration_options, budgeted_sat_options);
+      case Engine::portfolio:
+        return solve_using_portfolio(
+          sudoku, portfolio_exploration_worker.get(), budgeted_exploration_options, budgeted_sat_options);
+    }
+    __builtin_unreachable();
+  }
+
+ private:
+  Engine engine;
+  unsigned exploration_jobs;
+  ExplorationOptions exploration_options;
+  SatOptions sat_options;
+  Budget::Limits limits;
+  std::optional<unsigned> solutions_limit;
+  bool gave_up_;
+  // Explores with the portfolio engine, on the same thread for all Sudokus solved by this 'Solver'
+  std::unique_ptr<WorkStealingPool> portfolio_exploration_worker;
+};
+
+// With 'solve --count', 'solved' means that all solutions were counted (up to the limit)
+enum class SolveStatus { solved, failed, gave_up };
+
+template<unsigned size>
+struct BatchItem {
+  // The solution, or the input if it could not be solved
+  Sudoku<ValueCell, size> sudoku;
+  SolveStatus status;
+  // With 'solve --count'
+  unsigned solutions_count;
+};
+
+template<unsigned size>
+void output_sudoku(const Options& options, const Sudoku<ValueCell, size>& sudoku) {
+  if (options.compact) {
+    std::cout << sudoku.to_string() << '\n';
+  } else {
+    sudoku.dump(std::cout);
+  }
+}
+
+// 'read' is called repeatedly with a pointer to a Sudoku that it must overwrite with the next input.
+// It returns false when there is no more input.
+template<unsigned size, typename Read>
+int solve_batch(const Options& options, const Read& read) {
+  // Many small Sudokus: don't pay for the synchronization of C++ streams with C stdio
+  std::ios::sync_with_stdio(false);
+
+  bool any_failed = false;
+  bool any_gave_up = false;
+  const auto output = [&options, &any_failed, &any_gave_up](const unsigned index, const BatchItem<size>& item) {
+    // Keep one Sudoku (or count) in the output for each Sudoku in the input, to preserve the correspondence
+    if (options.count) {
+      std::cout << item.solutions_count << '\n';
     } else {
-      const auto solved = solve_using_exploration(sudoku);
+      output_sudoku(options, item.sudoku);
+    }
+    switch (item.status) {
+      case SolveStatus::solved:
+        break;
+      case SolveStatus::failed:
+        std::cerr << "FAILED to solve Sudoku #" << index + 1 << " using " << engine_name(options.engine) << std::endl;
+        any_failed = true;
+        break;
+      case SolveStatus::gave_up:
+        if (options.count) {
+          std::cerr << "GAVE UP counting the solutions of Sudoku #" << index + 1 << std::endl;
+        } else {
+          std::cerr << "GAVE UP solving Sudoku #" << index + 1 << " using " << engine_name(options.engine) << std::endl;
+        }
+        any_gave_up = true;
+        break;
+    }
+  };
 
-      if (solved) {
-        solved->dump(std::cout);
-        return 0;
-      } else {
-        std::cerr << "FAILED to solve this Sudoku using exploration" << std::endl;
-        return 1;
-      }
+  const auto solve = [&options](Solver<size>& solver, const Sudoku<ValueCell, size>& sudoku) {
+    if (options.count) {
+      const unsigned solutions_count = solver.count(sudoku);
+      return BatchItem<size>{sudoku, solver.gave_up() ? SolveStatus::gave_up : SolveStatus::solved, solutions_count};
     }
-  } else if (options.explain) {
-    typename Explanation<size>::Builder explanation_builder;
-    const auto solved = solve_using_exploration<size>(sudoku, explanation_builder);
-    const Explanation<size> explanation = explanation_builder.get();
 
-    if (options.text_path == "-") {
-      explain(explanation, TextExplainer<size>(std::cout));
-    } else if (options.text_path) {
-      std::ofstream out(*options.text_path);
-      assert(out.is_open());
-      explain(explanation, TextExplainer<size>(out));
+    const auto solved = solver(sudoku);
+    if (solved) {
+      return BatchItem<size>{*solved, SolveStatus::solved, 1};
+    } else {
+      return BatchItem<size>{sudoku, solver.gave_up() ? SolveStatus::gave_up : SolveStatus::failed, 0};
     }
+  };
 
-    if (options.html_path) {
-      explain(explanation, HtmlExplainer<size>(*options.html_path, options.width, options.height));
+  const unsigned jobs = jobs_count(options);
+
+  Sudoku<ValueCell, size> sudoku;
+  if (jobs == 1) {
+    Solver<size> solver(options);
+    for (unsigned index = 0; read(&sudoku); ++index) {
+      output(index, solve(solver, sudoku));
     }
+  } else {
+    // Not copies of a single 'Solver', which may own a thread
+    std::vector<Solver<size>> solvers;
+    solvers.reserve(jobs);
+    for (unsigned job = 0; job != jobs; ++job) {
+      solvers.emplace_back(options);
+    }
+    ReorderBuffer<BatchItem<size>, decltype(output)> reorder_buffer(output);
+    // Bound the memory used by Sudokus read but not yet output
+    const unsigned max_in_flight = 256 * jobs;
 
-    std::vector<std::unique_ptr<video::Serializer>> video_serializers;
-    if (options.video_frames_path) {
-      video_serializers.push_back(std::make_unique<video::FramesSerializer>(*options.video_frames_path));
+    WorkStealingPool pool(jobs);
+    for (unsigned index = 0; read(&sudoku); ++index) {
+      if (index >= max_in_flight) {
+        reorder_buffer.wait_until_consumed(index - max_in_flight);
+      }
+      pool.submit([&solvers, &solve, &reorder_buffer, index, sudoku](const unsigned worker_index) {
+        reorder_buffer.push(index, solve(solvers[worker_index], sudoku));
+      });
     }
-    if (options.video_path) {
-      video_serializers.push_back(std::make_unique<video::VideoSerializer>(
-        *options.video_path, options.width, options.height));
+    pool.wait();
+  }
+
+  // Unsolvable Sudokus are a more definite problem than Sudokus given up
+  return any_failed ? 1 : any_gave_up ? 2 : 0;
+}
+
+template<unsigned size>
+int main_(const Options& options) {
+  if (options.generate) {
+    SudokuGenerator<size> generator(options.seed ? *options.seed : std::random_device()(), jobs_count(options));
+    for (unsigned index = 0; index != options.puzzles; ++index) {
+      output_sudoku(options, generator.generate());
     }
-    if (video_serializers.size() > 1) {
-      assert(video_serializers.size() == 2);
-      video_serializers.push_back(std::make_unique<video::MultipleSerializer>(
-        std::vector<video::Serializer*>{video_serializers[0].get(), video_serializers[1].get()}));
+    return 0;
+  }
+
+  if (options.solve && options.batch && options.compact) {
+    // Decode Sudokus directly from the input, without copying it
+    const MappedInput input(options.input_path);
+    Lines lines(input.contents());
+    bool malformed = false;
+    const int result = solve_batch<size>(options, [&lines, &malformed](Sudoku<ValueCell, size>* sudoku) {
+      const auto line = lines.next();
+      if (!line) {
+        return false;
+      } else if (line->size() < size * size) {
+        std::cerr << "ERROR: line " << lines.line_number() << " is too short for a Sudoku of size " << size
+          << std::endl;
+        malformed = true;
+        return false;
+      } else {
+        *sudoku = Sudoku<ValueCell, size>::from_string(*line);
+        return true;
+      }
+    });
+    return malformed ? 1 : result;
+  }
+
+  std::ifstream input_file;
+  if (options.input_path != "-") {
+    // Race condition: the input file could have been deleted since 'CLI11_PARSE' checked. Risk accepted.
+    input_file.open(options.input_path);
+    assert(input_file.is_open());
+  }
+  std::istream& input = options.input_path == "-" ? std::cin : input_file;
+
+  if (options.solve && options.batch) {
+    // Sudokus are read one after the other, and may be separated by blank lines
+    return solve_batch<size>(options, [&input](Sudoku<ValueCell, size>* sudoku) {
+      if ((input >> std::ws).eof()) {
+        return false;
+      } else {
+        *sudoku = Sudoku<ValueCell, size>::load(input);
+        return true;
+      }
+    });
+  }
+
+  std::string line;
+  if (options.compact) {
+    std::getline(input, line);
+    if (line.size() < size * size) {
+      std::cerr << "ERROR: input is too short for a Sudoku of size " << size << std::endl;
+      return 1;
     }
-    if (!video_serializers.empty()) {
-      explain_as_video(explanation, video_serializers.back().get(), options.width, options.height);
+  }
+  const auto sudoku = options.compact
+    ? Sudoku<ValueCell, size>::from_string(line)
+    : Sudoku<ValueCell, size>::load(input);
+
+  if (options.solve && options.count) {
+    Solver<size> solver(options);
+    // Even if it gave up, this is a lower bound
+    std::cout << solver.count(sudoku) << std::endl;
+    if (solver.gave_up()) {
+      std::cerr << "GAVE UP counting the solutions of this Sudoku" << std::endl;
+      return 2;
+    } else {
+      return 0;
     }
+  } else if (options.solve) {
+    Solver<size> solver(options);
+    const auto solved = solver(sudoku);
 
     if (solved) {
+      output_sudoku(options, *solved);
       return 0;
+    } else if (solver.gave_up()) {
+      std::cerr << "GAVE UP solving this Sudoku using " << engine_name(options.engine) << std::endl;
+      return 2;
     } else {
-      std::cerr << "FAILED to solve this Sudoku using exploration" << std::endl;
+      std::cerr << "FAILED to solve this Sudoku using " << engine_name(options.engine) << std::endl;
       return 1;
     }
+  } else if (options.explain) {
+    // Explanations are drawn for grids that fit on a screen
+    if constexpr (size > 25) {
+      std::cerr << "ERROR: explanations are not supported for size " << size << std::endl;
+      return 1;
+    } else {
+      typename Explanation<size>::Builder explanation_builder;
+      const auto solved = solve_using_exploration<size>(sudoku, explanation_builder);
+      const Explanation<size> explanation = explanation_builder.get();
+
+      if (options.text_path == "-") {
+        explain(explanation, TextExplainer<size>(std::cout));
+      } else if (options.text_path) {
+        std::ofstream out(*options.text_path);
+        assert(out.is_open());
+        explain(explanation, TextExplainer<size>(out));
+      }
+
+      if (options.html_path) {
+        explain(explanation, HtmlExplainer<size>(*options.html_path, options.width, options.height));
+      }
+
+      std::vector<std::unique_ptr<video::Serializer>> video_serializers;
+      if (options.video_frames_path) {
+        video_serializers.push_back(std::make_unique<video::FramesSerializer>(*options.video_frames_path));
+      }
+      if (options.video_path) {
+        video_serializers.push_back(std::make_unique<video::VideoSerializer>(
+          *options.video_path, options.width, options.height));
+      }
+      if (video_serializers.size() > 1) {
+        assert(video_serializers.size() == 2);
+        video_serializers.push_back(std::make_unique<video::MultipleSerializer>(
+          std::vector<video::Serializer*>{video_serializers[0].get(), video_serializers[1].get()}));
+      }
+      if (!video_serializers.empty()) {
+        explain_as_video(explanation, video_serializers.back().get(), options.width, options.height);
+      }
+
+      if (solved) {
+        return 0;
+      } else {
+        std::cerr << "FAILED to solve this Sudoku using exploration" << std::endl;
+        return 1;
+      }
+    }
   } else if (options.benchmark) {
+    enable_heap_allocations_count();
+
     if (!solve_using_sat(sudoku)) {
       std::cerr << "FAILED to solve this Sudoku using SAT" << std::endl;
       return 1;
     }
 
+    // Compare the SAT encodings in the 'chrones' report
+    const std::vector<std::pair<std::string, SatOptions::Encoding>> sat_encodings{
+      {"pairwise", SatOptions::Encoding::pairwise},
+      {"sequential-counter", SatOptions::Encoding::sequential_counter},
+      {"commander", SatOptions::Encoding::commander},
+      {"product", SatOptions::Encoding::product},
+    };
+    for (unsigned encoding_index = 0; encoding_index != sat_encodings.size(); ++encoding_index) {
+      const auto& [name, encoding] = sat_encodings[encoding_index];
+      for (const bool pre_eliminate : {false, true}) {
+        CHRONE("SAT with encoding", encoding_index * 2 + pre_eliminate);
+        if (!solve_using_sat(sudoku, {.encoding = encoding, .pre_eliminate = pre_eliminate})) {
+          std::cerr << "FAILED to solve this Sudoku using SAT with the " << name << " encoding"
+            << (pre_eliminate ? " and pre-elimination" : "") << std::endl;
+          return 1;
+        }
+      }
+    }
+
+    if (!solve_using_dlx(sudoku)) {
+      std::cerr << "FAILED to solve this Sudoku using DLX" << std::endl;
+      return 1;
+    }
+
+    if (!solve_using_hybrid(sudoku)) {
+      std::cerr << "FAILED to solve this Sudoku using hybrid" << std::endl;
+      return 1;
+    }
+
+    if (!solve_using_portfolio(sudoku)) {
+      std::cerr << "FAILED to solve this Sudoku using portfolio" << std::endl;
+      return 1;
+    }
+
+    if constexpr (!has_compiled_exploration<size>) {
+      // The runtime-sized solver is built on its first use on each thread, with all the memory it may need
+      solve_using_exploration(sudoku);
+    }
+
+    const auto allocations_before_exploration = heap_allocations_count();
     if (!solve_using_exploration(sudoku)) {
       std::cerr << "FAILED to solve this Sudoku using exploration" << std::endl;
       return 1;
     }
+    const auto exploration_allocations = heap_allocations_count() - allocations_before_exploration;
+    std::cout << "Heap allocations while solving using exploration: " << exploration_allocations << std::endl;
+
+    ExplorationOptions trail_options;
+    trail_options.backtracking = ExplorationOptions::Backtracking::undo_trail;
+    const auto allocations_before_trail = heap_allocations_count();
+    if (!solve_using_exploration(sudoku, NullEventSink(), trail_options)) {
+      std::cerr << "FAILED to solve this Sudoku using exploration with a trail" << std::endl;
+      return 1;
+    }
+    const auto trail_allocations = heap_allocations_count() - allocations_before_trail;
+    std::cout << "Heap allocations while solving using exploration with a trail: " << trail_allocations << std::endl;
+
+    {
+      // Compare with the fastest kernel (used above) in the 'chrones' report
+      CHRONE("exploration with the scalar propagation kernel");
+      ExplorationOptions scalar_options;
+      scalar_options.kernel = PropagationKernel::scalar;
+      if (!solve_using_exploration(sudoku, NullEventSink(), scalar_options)) {
+        std::cerr << "FAILED to solve this Sudoku using exploration with the scalar propagation kernel" << std::endl;
+        return 1;
+      }
+    }
+
+    {
+      // Compare with the sequential exploration (used above) in the 'chrones' report
+      const unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+      CHRONE("exploration on threads", jobs);
+      if (!solve_using_parallel_exploration(sudoku, jobs)) {
+        std::cerr << "FAILED to solve this Sudoku using exploration on " << jobs << " threads" << std::endl;
+        return 1;
+      }
+    }
+
+    // Each rule alone, then all of them
+    std::vector<std::pair<std::string, DeductionRules>> rule_sets{{"no rules", {}}};
+    rule_sets.push_back({"naked-pairs", {.naked_pairs = true}});
+    rule_sets.push_back({"hidden-pairs", {.hidden_pairs = true}});
+    rule_sets.push_back({"pointing-pairs", {.pointing_pairs = true}});
+    rule_sets.push_back({"box-line-reductions", {.box_line_reductions = true}});
+    rule_sets.push_back({"x-wings", {.x_wings = true}});
+    rule_sets.push_back({"all rules", {true, true, true, true, true}});
+    for (unsigned rule_set_index = 0; rule_set_index != rule_sets.size(); ++rule_set_index) {
+      const auto& [name, rules] = rule_sets[rule_set_index];
+      ExplorationOptions rules_options;
+      rules_options.rules = rules;
+      {
+        CHRONE("exploration with rules", rule_set_index);
+        if (!solve_using_exploration(sudoku, NullEventSink(), rules_options)) {
+          std::cerr << "FAILED to solve this Sudoku using exploration with " << name << std::endl;
+          return 1;
+        }
+      }
+      std::cout << "Hypotheses made using exploration with " << name << ": "
+        << count_hypotheses_using_exploration(sudoku, rules_options) << std::endl;
+    }
+
+    // Each branching heuristic, with each value order
+    typedef ExplorationOptions::CellChoice CellChoice;
+    typedef ExplorationOptions::ValueOrder ValueOrder;
+    const std::vector<std::pair<std::string, CellChoice>> cell_choices{
+      {"mrv", CellChoice::mrv},
+      {"mrv-degree", CellChoice::mrv_degree},
+      {"buckets", CellChoice::buckets},
+      {"region", CellChoice::region},
+    };
+    const std::vector<std::pair<std::string, ValueOrder>> value_orders{
+      {"ascending", ValueOrder::ascending},
+      {"least-constraining", ValueOrder::least_constraining},
+    };
+    for (unsigned cell_choice_index = 0; cell_choice_index != cell_choices.size(); ++cell_choice_index) {
+      const auto& [cell_choice_name, cell_choice] = cell_choices[cell_choice_index];
+      for (unsigned value_order_index = 0; value_order_index != value_orders.size(); ++value_order_index) {
+        const auto& [value_order_name, value_order] = value_orders[value_order_index];
+        const std::string name = cell_choice_name + " and " + value_order_name + " values";
+        ExplorationOptions heuristic_options;
+        heuristic_options.cell_choice = cell_choice;
+        heuristic_options.value_order = value_order;
+        {
+          CHRONE("exploration with heuristics", cell_choice_index * value_orders.size() + value_order_index);
+          if (!solve_using_exploration(sudoku, NullEventSink(), heuristic_options)) {
+            std::cerr << "FAILED to solve this Sudoku using exploration with " << name << std::endl;
+            return 1;
+          }
+        }
+        std::cout << "Hypotheses made using exploration with " << name << ": "
+          << count_hypotheses_using_exploration(sudoku, heuristic_options) << std::endl;
+      }
+    }
 
     return 0;
   } else {
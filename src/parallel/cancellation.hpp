@@ -0,0 +1,75 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PARALLEL_CANCELLATION_HPP_
+#define PARALLEL_CANCELLATION_HPP_
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+
+// Lets a thread ask computations running on other threads to stop as soon as they can.
+// Computations either poll 'is_cancelled', or register a callback that interrupts them.
+class Cancellation {
+ public:
+  Cancellation() : cancelled(false), mutex(), interrupt() {}
+
+  Cancellation(const Cancellation&) = delete;
+  Cancellation& operator=(const Cancellation&) = delete;
+  Cancellation(Cancellation&&) = delete;
+  Cancellation& operator=(Cancellation&&) = delete;
+
+ public:
+  void cancel() {
+    std::lock_guard lock(mutex);
+    cancelled = true;
+    if (interrupt) {
+      interrupt();
+    }
+  }
+
+  bool is_cancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+  }
+
+  // Calls 'interrupt' (from the cancelling thread) if cancellation is requested while this object exists,
+  // including if it was requested before
+  class Interruption {
+   public:
+    Interruption(Cancellation* cancellation_, std::function<void()> interrupt) : cancellation(cancellation_) {
+      if (cancellation) {
+        std::lock_guard lock(cancellation->mutex);
+        assert(!cancellation->interrupt);
+        cancellation->interrupt = std::move(interrupt);
+        if (cancellation->cancelled) {
+          cancellation->interrupt();
+        }
+      }
+    }
+
+    ~Interruption() {
+      if (cancellation) {
+        std::lock_guard lock(cancellation->mutex);
+        cancellation->interrupt = nullptr;
+      }
+    }
+
+    Interruption(const Interruption&) = delete;
+    Interruption& operator=(const Interruption&) = delete;
+    Interruption(Interruption&&) = delete;
+    Interruption& operator=(Interruption&&) = delete;
+
+   private:
+    Cancellation* cancellation;
+  };
+
+ private:
+  std::atomic<bool> cancelled;
+  // Protects 'interrupt', so that it's never called after its 'Interruption' is destroyed
+  std::mutex mutex;
+  std::function<void()> interrupt;
+};
+
+#endif  // PARALLEL_CANCELLATION_HPP_
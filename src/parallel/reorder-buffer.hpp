@@ -0,0 +1,57 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PARALLEL_REORDER_BUFFER_HPP_
+#define PARALLEL_REORDER_BUFFER_HPP_
+
+#include <cassert>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+
+// Receives items produced in any order (typically by several threads),
+// and hands them to the consumer in the order of their indexes, starting at 0.
+template<typename Item, typename Consumer>
+class ReorderBuffer {
+ public:
+  explicit ReorderBuffer(const Consumer& consume_) :
+    consume(consume_),
+    mutex(),
+    consumed(),
+    pending(),
+    consumed_count(0)
+  {}
+
+ public:
+  void push(const unsigned index, const Item& item) {
+    {
+      std::lock_guard lock(mutex);
+      assert(index >= consumed_count);
+      assert(pending.count(index) == 0);
+
+      pending.emplace(index, item);
+      while (!pending.empty() && pending.begin()->first == consumed_count) {
+        consume(consumed_count, pending.begin()->second);
+        pending.erase(pending.begin());
+        ++consumed_count;
+      }
+    }
+    consumed.notify_all();
+  }
+
+  // Block until items with indexes lower than 'count' have been consumed.
+  // Lets the producer limit the number of items in flight.
+  void wait_until_consumed(const unsigned count) {
+    std::unique_lock lock(mutex);
+    consumed.wait(lock, [this, count]() { return consumed_count >= count; });
+  }
+
+ private:
+  Consumer consume;
+  std::mutex mutex;
+  std::condition_variable consumed;
+  std::map<unsigned, Item> pending;
+  unsigned consumed_count;
+};
+
+#endif  // PARALLEL_REORDER_BUFFER_HPP_
@@ -0,0 +1,110 @@
+// Copyright 2023 Vincent Jacques
+
+#include "timer.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+Timer::Timer() :
+  mutex(),
+  changed(),
+  deadline(),
+  callback(),
+  stopping(false),
+  thread()
+{}
+
+Timer::~Timer() {
+  if (thread.joinable()) {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    changed.notify_one();
+    thread.join();
+  }
+}
+
+void Timer::arm(const std::chrono::steady_clock::time_point deadline_, std::function<void()> callback_) {
+  {
+    std::lock_guard lock(mutex);
+    assert(!deadline);
+    deadline = deadline_;
+    callback = std::move(callback_);
+    if (!thread.joinable()) {
+      thread = std::thread(&Timer::run, this);
+    }
+  }
+  changed.notify_one();
+}
+
+void Timer::disarm() {
+  {
+    std::lock_guard lock(mutex);
+    deadline.reset();
+    callback = nullptr;
+  }
+  changed.notify_one();
+}
+
+void Timer::run() {
+  std::unique_lock lock(mutex);
+  while (!stopping) {
+    if (!deadline) {
+      changed.wait(lock);
+    } else if (std::chrono::steady_clock::now() >= *deadline) {
+      callback();
+      deadline.reset();
+      callback = nullptr;
+    } else {
+      changed.wait_until(lock, *deadline);
+    }
+  }
+}
+
+
+// LCOV_EXCL_START
+
+TEST_CASE("timer - calls back at the deadline") {
+  Timer timer;
+  std::atomic<bool> called = false;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+  timer.arm(deadline, [&called]() { called = true; });
+  while (!called) {
+    std::this_thread::yield();
+  }
+  CHECK(std::chrono::steady_clock::now() >= deadline);
+  timer.disarm();
+}
+
+TEST_CASE("timer - disarmed before the deadline") {
+  Timer timer;
+  std::atomic<bool> called = false;
+  timer.arm(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), [&called]() { called = true; });
+  timer.disarm();
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  CHECK(!called);
+}
+
+TEST_CASE("timer - several deadlines") {
+  Timer timer;
+  std::atomic<unsigned> count = 0;
+  for (unsigned i = 0; i != 3; ++i) {
+    timer.arm(std::chrono::steady_clock::now(), [&count]() { ++count; });
+    while (count != i + 1) {
+      std::this_thread::yield();
+    }
+    timer.disarm();
+  }
+  CHECK(count == 3);
+}
+
+TEST_CASE("timer - never armed") {
+  Timer timer;
+}
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,47 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PARALLEL_TIMER_HPP_
+#define PARALLEL_TIMER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+
+// Calls a function at a deadline, to interrupt computations that can't watch the clock themselves.
+// Its thread is started on first use, and kept for all the deadlines that follow, so that each deadline is cheap.
+class Timer {
+ public:
+  Timer();
+  ~Timer();
+
+  Timer(const Timer&) = delete;
+  Timer& operator=(const Timer&) = delete;
+  Timer(Timer&&) = delete;
+  Timer& operator=(Timer&&) = delete;
+
+ public:
+  // Calls 'callback' (from the timer's thread) at 'deadline', unless 'disarm' is called before.
+  // At most one deadline at a time.
+  void arm(std::chrono::steady_clock::time_point deadline, std::function<void()> callback);
+
+  // After this returns, the callback is not running, and won't be called
+  void disarm();
+
+ private:
+  void run();
+
+ private:
+  // Protects all members below. Held while calling 'callback', so that 'disarm' waits for it.
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  std::function<void()> callback;
+  bool stopping;
+  std::thread thread;
+};
+
+#endif  // PARALLEL_TIMER_HPP_
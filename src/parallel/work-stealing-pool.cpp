@@ -0,0 +1,192 @@
+// Copyright 2023 Vincent Jacques
+
+#include "work-stealing-pool.hpp"
+
+#include <cassert>
+#include <set>
+#include <utility>
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+namespace {
+
+// Lets 'submit' know if it's called from a worker
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local unsigned current_worker_index = 0;
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(const unsigned workers_count) :
+  queues(),
+  next_queue(0),
+  mutex(),
+  work_is_available(),
+  work_is_done(),
+  queued_count(0),
+  unfinished_count(0),
+  stopping(false),
+  threads()
+{  // NOLINT(whitespace/braces)
+  assert(workers_count > 0);
+
+  for (unsigned worker_index = 0; worker_index != workers_count; ++worker_index) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  for (unsigned worker_index = 0; worker_index != workers_count; ++worker_index) {
+    threads.emplace_back(&WorkStealingPool::work, this, worker_index);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  wait();
+
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  work_is_available.notify_all();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(Task task) {
+  const unsigned queue_index =
+    current_pool == this ? current_worker_index : next_queue.fetch_add(1) % queues.size();
+
+  // Count the task before making it available, so that counters never underflow
+  {
+    std::lock_guard lock(mutex);
+    ++queued_count;
+    ++unfinished_count;
+  }
+
+  {
+    std::lock_guard lock(queues[queue_index]->mutex);
+    queues[queue_index]->tasks.push_back(std::move(task));
+  }
+
+  work_is_available.notify_one();
+}
+
+void WorkStealingPool::wait() {
+  assert(current_pool != this);
+
+  std::unique_lock lock(mutex);
+  work_is_done.wait(lock, [this]() { return unfinished_count == 0; });
+}
+
+void WorkStealingPool::work(const unsigned worker_index) {
+  current_pool = this;
+  current_worker_index = worker_index;
+
+  while (true) {
+    {
+      std::unique_lock lock(mutex);
+      work_is_available.wait(lock, [this]() { return queued_count != 0 || stopping; });
+      if (queued_count == 0) {
+        assert(stopping);
+        return;
+      }
+    }
+
+    Task task;
+    // This can fail if another worker was faster, or if the task is counted but not yet in its queue
+    if (try_pop(worker_index, &task)) {
+      {
+        std::lock_guard lock(mutex);
+        --queued_count;
+      }
+
+      task(worker_index);
+
+      bool all_done = false;
+      {
+        std::lock_guard lock(mutex);
+        all_done = --unfinished_count == 0;
+      }
+      if (all_done) {
+        work_is_done.notify_all();
+      }
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool WorkStealingPool::try_pop(const unsigned worker_index, Task* task) {
+  {
+    Queue& own = *queues[worker_index];
+    std::lock_guard lock(own.mutex);
+    if (!own.tasks.empty()) {
+      *task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  for (unsigned delta = 1; delta != queues.size(); ++delta) {
+    Queue& other = *queues[(worker_index + delta) % queues.size()];
+    std::lock_guard lock(other.mutex);
+    if (!other.tasks.empty()) {
+      *task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+// LCOV_EXCL_START
+
+TEST_CASE("work-stealing pool - runs all tasks") {
+  std::atomic<unsigned> sum = 0;
+  {
+    WorkStealingPool pool(4);
+    for (unsigned i = 0; i != 1000; ++i) {
+      pool.submit([&sum, i](unsigned) { sum += i; });
+    }
+    pool.wait();
+    CHECK(sum == 499500);
+  }
+}
+
+TEST_CASE("work-stealing pool - tasks submitting tasks") {
+  std::atomic<unsigned> count = 0;
+  WorkStealingPool pool(3);
+  for (unsigned i = 0; i != 10; ++i) {
+    pool.submit([&pool, &count](unsigned) {
+      for (unsigned j = 0; j != 10; ++j) {
+        pool.submit([&count](unsigned) { ++count; });
+      }
+    });
+  }
+  pool.wait();
+  CHECK(count == 100);
+}
+
+TEST_CASE("work-stealing pool - worker indexes") {
+  std::mutex mutex;
+  std::set<unsigned> worker_indexes;
+  WorkStealingPool pool(2);
+  for (unsigned i = 0; i != 100; ++i) {
+    pool.submit([&mutex, &worker_indexes](unsigned worker_index) {
+      std::lock_guard lock(mutex);
+      worker_indexes.insert(worker_index);
+    });
+  }
+  pool.wait();
+  CHECK(!worker_indexes.empty());
+  CHECK(*worker_indexes.rbegin() < 2);
+}
+
+TEST_CASE("work-stealing pool - wait without tasks") {
+  WorkStealingPool pool(2);
+  pool.wait();
+}
+
+// LCOV_EXCL_STOP
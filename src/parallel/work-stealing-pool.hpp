@@ -0,0 +1,67 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PARALLEL_WORK_STEALING_POOL_HPP_
+#define PARALLEL_WORK_STEALING_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// A fixed set of worker threads, each with its own queue of tasks.
+// A worker runs tasks from the back of its own queue (most recently submitted first, for locality),
+// and when its queue is empty, it steals tasks from the front of other workers' queues (oldest first).
+class WorkStealingPool {
+ public:
+  // Tasks receive the index of the worker running them, to let them use per-worker state
+  typedef std::function<void(unsigned worker_index)> Task;
+
+  explicit WorkStealingPool(unsigned workers_count);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+  WorkStealingPool(WorkStealingPool&&) = delete;
+  WorkStealingPool& operator=(WorkStealingPool&&) = delete;
+
+ public:
+  unsigned workers_count() const { return queues.size(); }
+
+  // A task submitted from a worker of this pool goes to this worker's queue.
+  // Other tasks are distributed round-robin.
+  void submit(Task);
+
+  // Block until all submitted tasks (including the tasks they submitted) are done.
+  // Must not be called from a task.
+  void wait();
+
+ private:
+  void work(unsigned worker_index);
+  bool try_pop(unsigned worker_index, Task*);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::atomic<unsigned> next_queue;
+
+  // Protects the counters below, used to let idle workers sleep, and to wait for completion
+  std::mutex mutex;
+  std::condition_variable work_is_available;
+  std::condition_variable work_is_done;
+  unsigned queued_count;
+  unsigned unfinished_count;
+  bool stopping;
+
+  std::vector<std::thread> threads;
+};
+
+#endif  // PARALLEL_WORK_STEALING_POOL_HPP_
@@ -0,0 +1,87 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PORTFOLIO_SUDOKU_SOLVER_HPP_
+#define PORTFOLIO_SUDOKU_SOLVER_HPP_
+
+#include <atomic>
+#include <cassert>
+#include <optional>
+
+#include <chrones.hpp>
+
+#include "../exploration/sudoku-solver.hpp"
+#include "../parallel/cancellation.hpp"
+#include "../parallel/work-stealing-pool.hpp"
+#include "../puzzle/budget.hpp"
+#include "../puzzle/sudoku.hpp"
+#include "../sat/sudoku-solver.hpp"
+
+
+// Races exploration and SAT, and returns the result of the first one to finish, cancelling the other.
+// Each engine is orders of magnitude slower than the other on some Sudokus, so this caps the worst case.
+// SAT runs on the calling thread, to reuse the formulas it keeps for each thread. Exploration runs on
+// 'exploration_worker', a pool of one worker owned by the caller and used for nothing else, so that the same
+// thread, with the exploration solver it keeps, explores all the Sudokus of the caller.
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> solve_using_portfolio(
+  const Sudoku<ValueCell, size>& sudoku,
+  WorkStealingPool* exploration_worker,
+  ExplorationOptions exploration_options = {},
+  SatOptions sat_options = {}
+) {
+  CHRONE();
+
+  Cancellation cancellation;
+  exploration_options.cancellation = &cancellation;
+  sat_options.cancellation = &cancellation;
+
+  // Each engine has its own budget, with the same limits as the given one
+  Budget* const budget = exploration_options.budget;
+  assert(sat_options.budget == budget);
+  std::optional<Budget> exploration_budget;
+  std::optional<Budget> sat_budget;
+  if (budget) {
+    exploration_options.budget = &exploration_budget.emplace(budget->get_limits());
+    sat_options.budget = &sat_budget.emplace(budget->get_limits());
+  }
+
+  // Both engines are complete, so the first result is final, even if it's 'std::nullopt' for an unsolvable Sudoku.
+  // The cancelled engine finishes after that, so its result is ignored. An engine that gave up has no result.
+  std::atomic<bool> finished(false);
+  std::optional<Sudoku<ValueCell, size>> result;
+  const auto finish = [&](const std::optional<Sudoku<ValueCell, size>>& engine_result, const Budget* engine_budget) {
+    if (engine_budget && engine_budget->gave_up()) {
+      return;
+    }
+    if (!finished.exchange(true)) {
+      result = engine_result;
+      cancellation.cancel();
+    }
+  };
+
+  const auto explore = [&]() {
+    finish(solve_using_exploration(sudoku, NullEventSink(), exploration_options), exploration_options.budget);
+  };
+  // Capture a single reference, small enough for the task not to allocate
+  exploration_worker->submit([&explore](unsigned) { explore(); });
+  finish(solve_using_sat(sudoku, sat_options), sat_options.budget);
+  exploration_worker->wait();
+
+  if (!finished && budget) {
+    budget->give_up();
+  }
+  return result;
+}
+
+// For a single Sudoku
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> solve_using_portfolio(
+  const Sudoku<ValueCell, size>& sudoku,
+  const ExplorationOptions& exploration_options = {},
+  const SatOptions& sat_options = {}
+) {
+  WorkStealingPool exploration_worker(1);
+  return solve_using_portfolio(sudoku, &exploration_worker, exploration_options, sat_options);
+}
+
+#endif  // PORTFOLIO_SUDOKU_SOLVER_HPP_
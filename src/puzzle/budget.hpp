@@ -0,0 +1,91 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PUZZLE_BUDGET_HPP_
+#define PUZZLE_BUDGET_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+
+// Limits the effort spent on a single Sudoku. An engine that exhausts its budget gives up: it returns
+// 'std::nullopt' without having proven the Sudoku unsolvable, and 'gave_up' lets the caller tell the difference.
+// Thread-safe, so that the tasks of a parallel engine can all charge the same budget.
+class Budget {
+ public:
+  struct Limits {
+    std::optional<std::chrono::steady_clock::duration> time;
+    // Used by exploration
+    std::optional<uint64_t> hypotheses;
+    // Used by SAT
+    std::optional<uint64_t> conflicts;
+  };
+
+  explicit Budget(const Limits& limits_) :
+    limits(limits_),
+    deadline(),
+    hypotheses(0),
+    conflicts(0),
+    gave_up_(false)
+  {
+    if (limits.time) {
+      deadline = std::chrono::steady_clock::now() + *limits.time;
+    }
+  }
+
+ public:
+  const Limits& get_limits() const { return limits; }
+
+  // When the time limit expires, if any
+  const std::optional<std::chrono::steady_clock::time_point>& get_deadline() const { return deadline; }
+
+  // Called before each hypothesis. Returns false (and gives up) if the budget is exhausted.
+  bool spend_hypothesis() {
+    const uint64_t spent = hypotheses.fetch_add(1, std::memory_order_relaxed);
+    if ((limits.hypotheses && spent >= *limits.hypotheses) || is_time_up()) {
+      gave_up_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  // The number of conflicts that can still be spent, if limited
+  std::optional<uint64_t> remaining_conflicts() const {
+    if (limits.conflicts) {
+      const uint64_t spent = conflicts.load(std::memory_order_relaxed);
+      return spent < *limits.conflicts ? *limits.conflicts - spent : 0;
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  // Called after each slice of SAT solving. Returns false (and gives up) if the budget is exhausted.
+  bool spend_conflicts(const uint64_t count) {
+    const uint64_t spent = conflicts.fetch_add(count, std::memory_order_relaxed) + count;
+    if ((limits.conflicts && spent >= *limits.conflicts) || is_time_up()) {
+      gave_up_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  // For callers that split the budget between several engines, and find that all of them gave up
+  void give_up() { gave_up_ = true; }
+
+  bool gave_up() const { return gave_up_; }
+
+ private:
+  bool is_time_up() const {
+    return deadline && std::chrono::steady_clock::now() >= *deadline;
+  }
+
+ private:
+  Limits limits;
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  std::atomic<uint64_t> hypotheses;
+  std::atomic<uint64_t> conflicts;
+  std::atomic<bool> gave_up_;
+};
+
+#endif  // PUZZLE_BUDGET_HPP_
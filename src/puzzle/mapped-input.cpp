@@ -0,0 +1,96 @@
+// Copyright 2023 Vincent Jacques
+
+#include "mapped-input.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+MappedInput::MappedInput(const std::filesystem::path& path) :
+  mapping(nullptr),
+  mapping_size(0),
+  buffer(),
+  _contents()
+{  // NOLINT(whitespace/braces)
+  const bool is_stdin = path == "-";
+  // Race condition: the input file could have been deleted since 'CLI11_PARSE' checked. Risk accepted.
+  const int fd = is_stdin ? STDIN_FILENO : open(path.c_str(), O_RDONLY);
+  assert(fd >= 0);
+
+  struct stat status;
+  if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+    mapping_size = status.st_size;
+    mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      mapping = nullptr;
+      mapping_size = 0;
+    } else {
+      madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+      _contents = std::string_view(static_cast<const char*>(mapping), mapping_size);
+    }
+  }
+
+  if (mapping == nullptr) {
+    char chunk[1 << 16];
+    ssize_t count;
+    while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+      buffer.append(chunk, count);
+    }
+    _contents = buffer;
+  }
+
+  if (!is_stdin) {
+    close(fd);
+  }
+}
+
+MappedInput::~MappedInput() {
+  if (mapping != nullptr) {
+    munmap(mapping, mapping_size);
+  }
+}
+
+std::optional<std::string_view> Lines::next() {
+  while (!text.empty()) {
+    const auto end_of_line = text.find('\n');
+    std::string_view line = text.substr(0, end_of_line);
+    text.remove_prefix(end_of_line == std::string_view::npos ? text.size() : end_of_line + 1);
+    ++_line_number;
+
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (!line.empty()) {
+      return line;
+    }
+  }
+  return {};
+}
+
+
+// LCOV_EXCL_START
+
+TEST_CASE("lines") {
+  Lines lines("abc\n\ndef\r\nghi");
+  std::vector<std::pair<unsigned, std::string>> actual;
+  while (const auto line = lines.next()) {
+    actual.emplace_back(lines.line_number(), *line);
+  }
+  CHECK(actual == std::vector<std::pair<unsigned, std::string>>{{1, "abc"}, {3, "def"}, {4, "ghi"}});
+}
+
+TEST_CASE("lines - empty") {
+  Lines lines("");
+  CHECK(!lines.next());
+}
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,51 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PUZZLE_MAPPED_INPUT_HPP_
+#define PUZZLE_MAPPED_INPUT_HPP_
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+// The whole contents of an input file (or of stdin for "-"), without copying it when possible:
+// regular files are memory-mapped, and only pipes and the likes are read into memory.
+class MappedInput {
+ public:
+  explicit MappedInput(const std::filesystem::path&);
+  ~MappedInput();
+
+  MappedInput(const MappedInput&) = delete;
+  MappedInput& operator=(const MappedInput&) = delete;
+  MappedInput(MappedInput&&) = delete;
+  MappedInput& operator=(MappedInput&&) = delete;
+
+ public:
+  std::string_view contents() const { return _contents; }
+
+ private:
+  void* mapping;
+  std::size_t mapping_size;
+  std::string buffer;
+  std::string_view _contents;
+};
+
+// Iterates over the non-empty lines of a text, without copying them
+class Lines {
+ public:
+  explicit Lines(std::string_view text_) : text(text_), _line_number(0) {}
+
+ public:
+  std::optional<std::string_view> next();
+
+  // Of the line last returned by 'next', starting at 1
+  unsigned line_number() const { return _line_number; }
+
+ private:
+  std::string_view text;
+  unsigned _line_number;
+};
+
+#endif  // PUZZLE_MAPPED_INPUT_HPP_
@@ -0,0 +1,169 @@
+// Copyright 2023 Vincent Jacques
+
+#include "runtime-sudoku.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "../exploration/propagation-kernel.hpp"  // For tests, which compare with 'PeerIndexes'
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+namespace {
+
+unsigned integer_sqrt(const unsigned size) {
+  unsigned sqrt_size = 1;
+  while (sqrt_size * sqrt_size < size) {
+    ++sqrt_size;
+  }
+  assert(sqrt_size * sqrt_size == size);
+  return sqrt_size;
+}
+
+}  // namespace
+
+const RuntimeSudokuConstants& RuntimeSudokuConstants::get(const unsigned size) {
+  // A thread usually solves Sudokus of a single size, so it keeps the last constants it got,
+  // and only locks the shared cache when the size changes
+  thread_local const RuntimeSudokuConstants* last = nullptr;
+  if (last != nullptr && last->size == size) {
+    return *last;
+  }
+
+  static std::mutex mutex;
+  static std::map<unsigned, std::unique_ptr<const RuntimeSudokuConstants>> constants;
+
+  std::lock_guard lock(mutex);
+  auto& size_constants = constants[size];
+  if (!size_constants) {
+    size_constants = std::make_unique<const RuntimeSudokuConstants>(size);
+  }
+  last = size_constants.get();
+  return *last;
+}
+
+RuntimeSudokuConstants::RuntimeSudokuConstants(const unsigned size_) :
+  size(size_),
+  sqrt_size(integer_sqrt(size_)),
+  cells(size_ * size_),
+  regions(3 * size_),
+  regions_of(size_ * size_),
+  peers(size_ * size_),
+  padded_peers_count((3 * size_ - 2 * sqrt_size - 1 + 7) / 8 * 8),
+  peer_indexes(size_ * size_ * padded_peers_count)
+{
+  for (unsigned row = 0; row != size; ++row) {
+    for (unsigned col = 0; col != size; ++col) {
+      cells[row * size + col] = {row, col};
+      const unsigned square = row / sqrt_size * sqrt_size + col / sqrt_size;
+      regions[row].push_back({row, col});
+      regions[size + col].push_back({row, col});
+      regions[2 * size + square].push_back({row, col});
+      regions_of[row * size + col] = {row, size + col, 2 * size + square};
+    }
+  }
+
+  // The other cells of the row, then of the column, then of the square (minus those already listed)
+  for (unsigned row = 0; row != size; ++row) {
+    for (unsigned col = 0; col != size; ++col) {
+      auto& cell_peers = peers[row * size + col];
+      for (unsigned peer_col = 0; peer_col != size; ++peer_col) {
+        if (peer_col != col) {
+          cell_peers.push_back({row, peer_col});
+        }
+      }
+      for (unsigned peer_row = 0; peer_row != size; ++peer_row) {
+        if (peer_row != row) {
+          cell_peers.push_back({peer_row, col});
+        }
+      }
+      for (const auto& [peer_row, peer_col] : regions[regions_of[row * size + col][2]]) {
+        if (peer_row != row && peer_col != col) {
+          cell_peers.push_back({peer_row, peer_col});
+        }
+      }
+
+      int32_t* const indexes = &peer_indexes[(row * size + col) * padded_peers_count];
+      for (unsigned i = 0; i != padded_peers_count; ++i) {
+        const auto [peer_row, peer_col] = i < cell_peers.size() ? cell_peers[i] : Coordinates(row, col);
+        indexes[i] = peer_row * size + peer_col;
+      }
+    }
+  }
+}
+
+
+// LCOV_EXCL_START
+
+template<unsigned size>
+void check_constants() {
+  const auto& constants = RuntimeSudokuConstants::get(size);
+  CHECK(&RuntimeSudokuConstants::get(size) == &constants);
+  CHECK(constants.size == size);
+  CHECK(constants.sqrt_size == SudokuConstants<size>::sqrt_size);
+  CHECK(constants.regions.size() == SudokuConstants<size>::regions.size());
+  for (const unsigned region : SudokuConstants<size>::region_indexes) {
+    CHECK(constants.regions[region].size() == size);
+    for (const unsigned i : SudokuConstants<size>::values) {
+      CHECK(constants.regions[region][i] == SudokuConstants<size>::regions[region][i]);
+    }
+  }
+  CHECK(constants.cells.size() == size * size);
+  for (unsigned index = 0; index != size * size; ++index) {
+    CHECK(constants.cells[index] == SudokuConstants<size>::cells[index]);
+  }
+  CHECK(constants.padded_peers_count == PeerIndexes<size>::padded_count);
+  for (const auto& [row, col] : SudokuConstants<size>::cells) {
+    for (unsigned i = 0; i != PeerIndexes<size>::padded_count; ++i) {
+      CHECK(
+        constants.peer_indexes[(row * size + col) * constants.padded_peers_count + i]
+        == PeerIndexes<size>::indexes[row * size + col][i]);
+    }
+    CHECK(constants.regions_of[row * size + col] == SudokuConstants<size>::regions_of[row][col]);
+    const auto& peers = constants.peers[row * size + col];
+    CHECK(peers.size() == SudokuConstants<size>::peers_count);
+    for (unsigned i = 0; i != SudokuConstants<size>::peers_count; ++i) {
+      CHECK(peers[i] == SudokuConstants<size>::peers[row][col][i]);
+    }
+  }
+}
+
+TEST_CASE("runtime constants - 4") {
+  check_constants<4>();
+}
+
+TEST_CASE("runtime constants - 9") {
+  check_constants<9>();
+}
+
+TEST_CASE("runtime constants - alternating sizes") {
+  const auto& constants_4 = RuntimeSudokuConstants::get(4);
+  const auto& constants_9 = RuntimeSudokuConstants::get(9);
+  CHECK(&RuntimeSudokuConstants::get(4) == &constants_4);
+  CHECK(&RuntimeSudokuConstants::get(9) == &constants_9);
+  CHECK(constants_4.size == 4);
+  CHECK(constants_9.size == 9);
+}
+
+TEST_CASE("runtime Sudoku - round trip") {
+  Sudoku<ValueCell, 4> sudoku;
+  sudoku.cell({0, 0}).set(2);
+  sudoku.cell({1, 3}).set(0);
+  sudoku.cell({3, 2}).set(3);
+
+  const RuntimeSudoku runtime_sudoku(sudoku);
+  CHECK(runtime_sudoku.size() == 4);
+  CHECK(runtime_sudoku.get({0, 0}) == 2);
+  CHECK(runtime_sudoku.get({1, 3}) == 0);
+  CHECK(runtime_sudoku.get({3, 2}) == 3);
+  CHECK(runtime_sudoku.get({2, 2}) == std::nullopt);
+
+  const auto round_trip = runtime_sudoku.to_sudoku<4>();
+  for (const auto& coords : SudokuConstants<4>::cells) {
+    CHECK(round_trip.cell(coords).get() == sudoku.cell(coords).get());
+  }
+}
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,98 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef PUZZLE_RUNTIME_SUDOKU_HPP_
+#define PUZZLE_RUNTIME_SUDOKU_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "sudoku.hpp"
+
+
+// Like 'SudokuConstants', for a size only known at runtime
+class RuntimeSudokuConstants {
+ public:
+  // Built on first use for each size, then shared by all threads. Doesn't lock when called again with the same size.
+  static const RuntimeSudokuConstants& get(unsigned size);
+
+  explicit RuntimeSudokuConstants(unsigned size);
+
+ public:
+  const unsigned size;
+  const unsigned sqrt_size;
+  // Indexed by 'row * size + col', like 'SudokuConstants<size>::cells'
+  std::vector<Coordinates> cells;
+  // Rows, then columns, then squares, in the same order as 'SudokuConstants<size>::regions'
+  std::vector<std::vector<Coordinates>> regions;
+  // Indexed by 'row * size + col'
+  std::vector<std::array<unsigned, 3>> regions_of;
+  // Indexed by 'row * size + col', in the same order as 'SudokuConstants<size>::peers'
+  std::vector<std::vector<Coordinates>> peers;
+  // Like 'PeerIndexes<size>': the peers of each cell, as indexes in 'cells', padded with the cell itself
+  // up to 'padded_peers_count', a multiple of 8. Cell 'index' has its own 'padded_peers_count' elements,
+  // starting at 'peer_indexes[index * padded_peers_count]'.
+  const unsigned padded_peers_count;
+  std::vector<int32_t> peer_indexes;
+};
+
+// A Sudoku whose size is only known at runtime, solved by the engines that gain nothing from a compile-time size.
+// They are then compiled once for all sizes, instead of once for each 'Sudoku<ValueCell, size>'.
+class RuntimeSudoku {
+ public:
+  explicit RuntimeSudoku(const unsigned size_) : _size(size_), values(size_ * size_) {}
+
+  template<unsigned size>
+  explicit RuntimeSudoku(const Sudoku<ValueCell, size>& sudoku) : RuntimeSudoku(size) {
+    for (const auto& cell : sudoku.cells()) {
+      const auto value = cell.get();
+      if (value) {
+        set(cell.coordinates(), *value);
+      }
+    }
+  }
+
+ public:
+  template<unsigned size>
+  Sudoku<ValueCell, size> to_sudoku() const {
+    assert(_size == size);
+    Sudoku<ValueCell, size> sudoku;
+    for (const auto& coords : SudokuConstants<size>::cells) {
+      const auto value = get(coords);
+      if (value) {
+        sudoku.cell(coords).set(*value);
+      }
+    }
+    return sudoku;
+  }
+
+  unsigned size() const { return _size; }
+
+  std::optional<unsigned> get(const Coordinates& coords) const {
+    return values[coords.first * _size + coords.second];
+  }
+
+  void set(const Coordinates& coords, const unsigned value) {
+    assert(value < _size);
+    values[coords.first * _size + coords.second] = value;
+  }
+
+ private:
+  unsigned _size;
+  // Indexed by 'row * size + col'
+  std::vector<std::optional<unsigned>> values;
+};
+
+// For the adapters of runtime-sized engines to 'Sudoku<ValueCell, size>'
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> to_sudoku(const std::optional<RuntimeSudoku>& sudoku) {
+  if (sudoku) {
+    return sudoku->to_sudoku<size>();
+  } else {
+    return std::nullopt;
+  }
+}
+
+#endif  // PUZZLE_RUNTIME_SUDOKU_HPP_
@@ -12,3 +12,17 @@ static_assert(SudokuAlphabet<4>::get_value('1') == 0);
 static_assert(SudokuAlphabet<4>::get_value('2') == 1);
 static_assert(SudokuAlphabet<4>::get_value('3') == 2);
 static_assert(SudokuAlphabet<4>::get_value('4') == 3);
+static_assert(SudokuAlphabet<4>::get_value('0') == std::nullopt);
+static_assert(SudokuAlphabet<4>::get_value('5') == std::nullopt);
+static_assert(SudokuAlphabet<16>::get_value('G') == 15);
+static_assert(SudokuAlphabet<16>::get_value('H') == std::nullopt);
+static_assert(SudokuAlphabet<25>::get_value('P') == 24);
+static_assert(SudokuAlphabet<25>::get_value('\xff') == std::nullopt);
+static_assert(SudokuAlphabet<36>::get_value('Z') == 34);
+static_assert(SudokuAlphabet<36>::get_value('0') == 35);
+static_assert(SudokuAlphabet<36>::get_value('a') == std::nullopt);
+static_assert(SudokuAlphabet<49>::get_value('m') == 48);
+static_assert(SudokuAlphabet<49>::get_value('n') == std::nullopt);
+static_assert(SudokuAlphabet<64>::get_symbol(63) == '/');
+static_assert(SudokuAlphabet<64>::get_value('+') == 62);
+static_assert(SudokuAlphabet<64>::get_value('.') == std::nullopt);
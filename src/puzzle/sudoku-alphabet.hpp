@@ -3,8 +3,8 @@
 #ifndef PUZZLE_SUDOKU_ALPHABET_HPP_
 #define PUZZLE_SUDOKU_ALPHABET_HPP_
 
+#include <array>
 #include <cassert>
-#include <map>
 #include <optional>
 
 
@@ -26,18 +26,44 @@ template<> struct Symbols<25> {
   static constexpr char symbols[] = "123456789ABCDEFGHIJKLMNOP";
 };
 
+// Each alphabet extends the previous one, then '0', then lowercase letters, then '+' and '/'
+template<> struct Symbols<36> {
+  static constexpr char symbols[] = "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ0";
+};
+
+template<> struct Symbols<49> {
+  static constexpr char symbols[] = "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ0abcdefghijklm";
+};
+
+template<> struct Symbols<64> {
+  static constexpr char symbols[] = "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ0abcdefghijklmnopqrstuvwxyz+/";
+};
+
 template<unsigned size>
 class SudokuAlphabet {
   static_assert(sizeof(Symbols<size>::symbols) == size + 1);
 
+ private:
+  // Decoding table, indexed by character: 'size' means "no value"
+  static constexpr auto make_values() {
+    std::array<unsigned char, 256> values;
+    values.fill(size);
+    for (unsigned i = 0; i != size; ++i) {
+      values[static_cast<unsigned char>(Symbols<size>::symbols[i])] = i;
+    }
+    return values;
+  }
+
+  static constexpr auto values = make_values();
+
  public:
   static constexpr std::optional<unsigned> get_value(char c) {
-    for (unsigned i = 0; i != size; ++i) {
-      if (Symbols<size>::symbols[i] == c) {
-        return i;
-      }
+    const unsigned value = values[static_cast<unsigned char>(c)];
+    if (value == size) {
+      return {};
+    } else {
+      return value;
     }
-    return {};
   }
 
   static constexpr char get_symbol(std::optional<unsigned> value) {
@@ -105,3 +105,17 @@ static_assert(SudokuConstants<9>::regions_of == decltype(SudokuConstants<9>::reg
     {8, 9, 24}, {8, 10, 24}, {8, 11, 24}, {8, 12, 25}, {8, 13, 25}, {8, 14, 25}, {8, 15, 26}, {8, 16, 26}, {8, 17, 26}
   }},
 }});
+
+static_assert(SudokuConstants<4>::peers[0][0] == std::array<Coordinates, SudokuConstants<4>::peers_count>{{
+  {0, 1}, {0, 2}, {0, 3}, {1, 0}, {2, 0}, {3, 0}, {1, 1},
+}});
+
+static_assert(SudokuConstants<9>::peers[4][4] == std::array<Coordinates, SudokuConstants<9>::peers_count>{{
+  {4, 0}, {4, 1}, {4, 2}, {4, 3}, {4, 5}, {4, 6}, {4, 7}, {4, 8},
+  {0, 4}, {1, 4}, {2, 4}, {3, 4}, {5, 4}, {6, 4}, {7, 4}, {8, 4},
+  {3, 3}, {3, 5}, {5, 3}, {5, 5},
+}});
+
+static_assert(SudokuConstants<9>::peers_count == 20);
+static_assert(SudokuConstants<16>::peers_count == 39);
+static_assert(SudokuConstants<25>::peers_count == 64);
@@ -9,6 +9,26 @@
 
 typedef std::pair<unsigned, unsigned> Coordinates;
 
+// The table returned by 'make', computed at compile time if 'at_compile_time', and otherwise when the program starts.
+// Tables computed at startup are initialized in no particular order, so 'make' must not read another one.
+template<auto make, bool at_compile_time>
+struct PrecomputedTable {
+  static constexpr auto table = make();
+};
+
+template<auto make>
+struct PrecomputedTable<make, false> {
+ private:
+  // Through a volatile pointer, so that the compiler doesn't even try to evaluate 'make' at compile time
+  static auto compute() {
+    const volatile auto make_at_runtime = make;
+    return make_at_runtime();
+  }
+
+ public:
+  static inline const auto table = compute();
+};
+
 
 template<unsigned size>
 class SudokuConstants {
@@ -99,6 +119,17 @@ class SudokuConstants {
     return regions_of;
   }
 
+  static constexpr auto make_peers() {
+    std::array<std::array<std::array<Coordinates, peers_count>, size>, size> peers;
+    for (unsigned row : values) {
+      for (unsigned col : values) {
+        unsigned count = 0;
+        for_each_peer(row, col, [&](const Coordinates& peer) { peers[row][col][count++] = peer; });
+      }
+    }
+    return peers;
+  }
+
  public:
   static constexpr auto sqrt_size = sqrt(size);
   static constexpr auto values = make_values();
@@ -106,6 +137,34 @@ class SudokuConstants {
   static constexpr auto region_indexes = make_region_indexes();
   static constexpr auto regions = make_regions();
   static constexpr auto regions_of = make_regions_of();
+  // Cells that can't have the same value as a given cell, each listed once
+  static constexpr unsigned peers_count = 3 * size - 2 * sqrt_size - 1;
+
+  // The other cells of a cell's row, then of its column, then of its square (minus those already listed).
+  // For tables derived from the peers, that can't read 'peers' while they are computed at startup.
+  template<typename F>
+  static constexpr void for_each_peer(const unsigned row, const unsigned col, F f) {
+    for (unsigned peer_col : values) {
+      if (peer_col != col) {
+        f(Coordinates(row, peer_col));
+      }
+    }
+    for (unsigned peer_row : values) {
+      if (peer_row != row) {
+        f(Coordinates(peer_row, col));
+      }
+    }
+    for (const auto& [peer_row, peer_col] : regions[regions_of[row][col][2]]) {
+      if (peer_row != row && peer_col != col) {
+        f(Coordinates(peer_row, peer_col));
+      }
+    }
+  }
+
+  // The tables with an entry per peer of each cell are too large for the compiler to evaluate them
+  // in reasonable time beyond 25x25 Sudokus
+  static constexpr bool peer_tables_at_compile_time = size <= 25;
+  static constexpr const auto& peers = PrecomputedTable<&make_peers, peer_tables_at_compile_time>::table;
 
  private:
   static_assert(sqrt_size * sqrt_size == size, "'size' must be a perfect square");
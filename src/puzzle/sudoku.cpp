@@ -5,6 +5,7 @@
 
 #include <cassert>
 #include <map>
+#include <string>
 
 #include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
 
@@ -35,22 +36,71 @@ void Sudoku<ValueCell, size>::dump(std::ostream& os) const {
   for (const unsigned row : SudokuConstants<size>::values) {
     for (const unsigned col : SudokuConstants<size>::values) {
       const auto value = this->cell({row, col}).get();
-      os << SudokuAlphabet<size>::get_symbol(*value);
+      os << SudokuAlphabet<size>::get_symbol(value);
     }
     os << '\n';
   }
 }
 
+template<unsigned size>
+Sudoku<ValueCell, size> Sudoku<ValueCell, size>::from_string(const std::string_view line) {
+  assert(line.size() >= size * size);
+
+  Sudoku<ValueCell, size> sudoku;
+
+  const char* c = line.data();
+  for (auto& cell : sudoku.cells()) {
+    const std::optional<unsigned> value = SudokuAlphabet<size>::get_value(*c);
+    if (value) {
+      cell.set(*value);
+    }
+    ++c;
+  }
+
+  return sudoku;
+}
+
+template<unsigned size>
+std::string Sudoku<ValueCell, size>::to_string() const {
+  std::string line(size * size, '.');
+
+  auto c = line.begin();
+  for (const auto& cell : this->cells()) {
+    *c = SudokuAlphabet<size>::get_symbol(cell.get());
+    ++c;
+  }
+
+  return line;
+}
+
 template class Sudoku<ValueCell, 4>;
 template class Sudoku<ValueCell, 9>;
 template class Sudoku<ValueCell, 16>;
 template class Sudoku<ValueCell, 25>;
+template class Sudoku<ValueCell, 36>;
+template class Sudoku<ValueCell, 49>;
+template class Sudoku<ValueCell, 64>;
 
 
 // LCOV_EXCL_START
 
 struct TestCell { unsigned val = 0; };
 
+TEST_CASE("sudoku - compact format") {
+  const std::string line = "1..4..2..2..3..1";
+  const auto sudoku = Sudoku<ValueCell, 4>::from_string(line);
+  CHECK(sudoku.cell({0, 0}).get() == 0);
+  CHECK(!sudoku.cell({0, 1}).get());
+  CHECK(sudoku.cell({0, 3}).get() == 3);
+  CHECK(sudoku.cell({3, 3}).get() == 0);
+  CHECK(sudoku.to_string() == line);
+}
+
+TEST_CASE("sudoku - compact format - zeros and trailing characters") {
+  const auto sudoku = Sudoku<ValueCell, 4>::from_string("1004002002003001,ignored");
+  CHECK(sudoku.to_string() == "1..4..2..2..3..1");
+}
+
 TEST_CASE("sudoku - cells") {
   Sudoku<TestCell, 4> sudoku;
   std::vector<Coordinates> cells;
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -311,10 +312,13 @@ class ValueCell {
 template<unsigned size>
 class Sudoku<ValueCell, size> : public SudokuBase<ValueCell, size> {
  public:
+  // Grid format: 'size' lines of 'size' characters
   static Sudoku<ValueCell, size> load(std::istream&);
   void dump(std::ostream&) const;
 
-  static Sudoku<ValueCell, size> from_string(const std::string&);
+  // Compact format: all 'size * size' cells on a single line, row after row.
+  // Characters after the last cell are ignored.
+  static Sudoku<ValueCell, size> from_string(std::string_view);
   std::string to_string() const;
 };
 
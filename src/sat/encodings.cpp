@@ -0,0 +1,59 @@
+// Copyright 2023 Vincent Jacques
+
+#include "encodings.hpp"
+
+#include <doctest.h>  // NOLINT(build/include_order): keep last because it defines really common names like CHECK
+
+
+// LCOV_EXCL_START
+
+void check_at_most_one(const SatOptions::Encoding encoding) {
+  for (unsigned n = 0; n != 12; ++n) {
+    Minisat::Solver solver;
+    const auto literals = new_literals(&solver, n);
+    add_at_most_one(&solver, literals, encoding);
+
+    // No literal, or any single literal, can be true
+    Minisat::vec<Minisat::Lit> assumptions;
+    for (const Minisat::Lit literal : literals) {
+      assumptions.push(~literal);
+    }
+    CHECK(solver.solve(assumptions));
+    for (unsigned i = 0; i != n; ++i) {
+      assumptions.clear();
+      assumptions.push(literals[i]);
+      CHECK(solver.solve(assumptions));
+      for (unsigned j = 0; j != n; ++j) {
+        CHECK((solver.model[Minisat::var(literals[j])] == Minisat::l_True) == (i == j));
+      }
+    }
+
+    // No pair of literals can be true
+    for (unsigned i = 0; i != n; ++i) {
+      for (unsigned j = i + 1; j != n; ++j) {
+        assumptions.clear();
+        assumptions.push(literals[i]);
+        assumptions.push(literals[j]);
+        CHECK(!solver.solve(assumptions));
+      }
+    }
+  }
+}
+
+TEST_CASE("at most one - pairwise") {
+  check_at_most_one(SatOptions::Encoding::pairwise);
+}
+
+TEST_CASE("at most one - sequential counter") {
+  check_at_most_one(SatOptions::Encoding::sequential_counter);
+}
+
+TEST_CASE("at most one - commander") {
+  check_at_most_one(SatOptions::Encoding::commander);
+}
+
+TEST_CASE("at most one - product") {
+  check_at_most_one(SatOptions::Encoding::product);
+}
+
+// LCOV_EXCL_STOP
@@ -0,0 +1,117 @@
+// Copyright 2023 Vincent Jacques
+
+#ifndef SAT_ENCODINGS_HPP_
+#define SAT_ENCODINGS_HPP_
+
+#include <minisat/core/Solver.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "sudoku-solver.hpp"
+
+
+inline std::vector<Minisat::Lit> new_literals(Minisat::Solver* solver, const unsigned count) {
+  std::vector<Minisat::Lit> literals;
+  literals.reserve(count);
+  for (unsigned i = 0; i != count; ++i) {
+    literals.push_back(Minisat::mkLit(solver->newVar()));
+  }
+  return literals;
+}
+
+inline void add_pairwise(Minisat::Solver* solver, const std::vector<Minisat::Lit>& literals) {
+  for (unsigned i = 0; i != literals.size(); ++i) {
+    for (unsigned j = i + 1; j != literals.size(); ++j) {
+      solver->addClause(~literals[i], ~literals[j]);
+    }
+  }
+}
+
+inline void add_sequential_counter(Minisat::Solver* solver, const std::vector<Minisat::Lit>& literals) {
+  const unsigned n = literals.size();
+  if (n < 2) {
+    return;
+  }
+
+  // 'counters[i]' is true when one of 'literals[0]' to 'literals[i]' is true
+  const auto counters = new_literals(solver, n - 1);
+  solver->addClause(~literals[0], counters[0]);
+  for (unsigned i = 1; i != n - 1; ++i) {
+    solver->addClause(~literals[i], counters[i]);
+    solver->addClause(~counters[i - 1], counters[i]);
+    solver->addClause(~literals[i], ~counters[i - 1]);
+  }
+  solver->addClause(~literals[n - 1], ~counters[n - 2]);
+}
+
+inline void add_commander(Minisat::Solver* solver, const std::vector<Minisat::Lit>& literals) {
+  constexpr unsigned group_size = 3;
+  if (literals.size() <= group_size) {
+    add_pairwise(solver, literals);
+    return;
+  }
+
+  // Each group has at most one true literal, and its commander is true when it does
+  std::vector<Minisat::Lit> commanders;
+  for (unsigned begin = 0; begin < literals.size(); begin += group_size) {
+    const std::vector<Minisat::Lit> group(
+      literals.begin() + begin,
+      literals.begin() + std::min<unsigned>(begin + group_size, literals.size()));
+    add_pairwise(solver, group);
+    const Minisat::Lit commander = Minisat::mkLit(solver->newVar());
+    for (const Minisat::Lit literal : group) {
+      solver->addClause(~literal, commander);
+    }
+    commanders.push_back(commander);
+  }
+  add_commander(solver, commanders);
+}
+
+inline void add_product(Minisat::Solver* solver, const std::vector<Minisat::Lit>& literals) {
+  const unsigned n = literals.size();
+  if (n <= 4) {
+    add_pairwise(solver, literals);
+    return;
+  }
+
+  // Place literals on a grid: two true literals would be on two rows, or on two columns of the same row
+  unsigned cols = 1;
+  while (cols * cols < n) {
+    ++cols;
+  }
+  const unsigned rows = (n + cols - 1) / cols;
+  const auto row_literals = new_literals(solver, rows);
+  const auto col_literals = new_literals(solver, cols);
+  for (unsigned i = 0; i != n; ++i) {
+    solver->addClause(~literals[i], row_literals[i / cols]);
+    solver->addClause(~literals[i], col_literals[i % cols]);
+  }
+  add_product(solver, row_literals);
+  add_product(solver, col_literals);
+}
+
+// Adds clauses (and maybe auxiliary variables) to 'solver', ensuring that at most one of 'literals' is true
+inline void add_at_most_one(
+  Minisat::Solver* solver,
+  const std::vector<Minisat::Lit>& literals,
+  const SatOptions::Encoding encoding
+) {
+  switch (encoding) {
+    case SatOptions::Encoding::pairwise:
+      add_pairwise(solver, literals);
+      return;
+    case SatOptions::Encoding::sequential_counter:
+      add_sequential_counter(solver, literals);
+      return;
+    case SatOptions::Encoding::commander:
+      add_commander(solver, literals);
+      return;
+    case SatOptions::Encoding::product:
+      add_product(solver, literals);
+      return;
+  }
+  __builtin_unreachable();
+}
+
+#endif  // SAT_ENCODINGS_HPP_
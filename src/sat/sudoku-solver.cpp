@@ -2,114 +2,277 @@
 
 #include "sudoku-solver.hpp"
 
-#include <minisat/simp/SimpSolver.h>
+#include <minisat/core/Solver.h>
 
-#include <chrones.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
-#include "../puzzle/sudoku-constants.hpp"
+#include <chrones.hpp>
 
+#include "../parallel/timer.hpp"
+#include "encodings.hpp"
 
-template<unsigned size>
-std::optional<Sudoku<ValueCell, size>> solve_using_sat(Sudoku<ValueCell, size> sudoku) {
-  CHRONE();
 
-  Minisat::SimpSolver solver;
+namespace {
 
-  std::array<std::array<std::array<Minisat::Var, size>, size>, size> has_value;
+// A Minisat solver loaded with the structural constraints, restricted to some candidates: cells without any
+// candidate get no variables (their value is already known), and the other cells get one variable by candidate.
+// Givens that are not excluded from the formula are passed as assumptions to 'solve'. Clauses learned while solving
+// are implied by the structural constraints alone, so the same formula can be reused for the next Sudokus.
+class Formula {
+ public:
+  Formula(
+    const RuntimeSudokuConstants& constants,
+    const SatCandidates& candidates,
+    const SatOptions::Encoding encoding
+  ) :
+    size(constants.size),
+    has_value(size * size * size)
   {
-    CHRONE("variables");
-    for (const unsigned row : SudokuConstants<size>::values) {
-      for (const unsigned col : SudokuConstants<size>::values) {
-        for (const unsigned val : SudokuConstants<size>::values) {
-          has_value[row][col][val] = solver.newVar();
+    CHRONE("structural constraints");
+
+    for (unsigned row = 0; row != size; ++row) {
+      for (unsigned col = 0; col != size; ++col) {
+        for (unsigned val = 0; val != size; ++val) {
+          variable(row, col, val) =
+            (candidates[row * size + col] >> val) & 1 ? solver.newVar() : Minisat::var_Undef;
         }
       }
     }
-  }
 
-  {
-    CHRONE("structural constraints");
     // Structural constraints: each cell...
-    for (const auto& cell : SudokuConstants<size>::cells) {
-      const auto [row, col] = cell;
-
-      {
-        // ... has at least one value
-        Minisat::vec<Minisat::Lit> clause;
-        for (const unsigned val : SudokuConstants<size>::values) {
-          clause.push(Minisat::mkLit(has_value[row][col][val]));
+    for (unsigned row = 0; row != size; ++row) {
+      for (unsigned col = 0; col != size; ++col) {
+        const auto literals = cell_literals(row, col);
+        if (literals.empty()) {
+          continue;
         }
-        solver.addClause(clause);
-      }
 
-      // ... has at most one value
-      for (const unsigned val1 : SudokuConstants<size>::values) {
-        for (const unsigned val2 : SudokuConstants<size>::values) {
-          if (val1 < val2) {
-            solver.addClause(~Minisat::mkLit(has_value[row][col][val1]), ~Minisat::mkLit(has_value[row][col][val2]));
+        {
+          // ... has at least one value
+          Minisat::vec<Minisat::Lit> clause;
+          for (const Minisat::Lit literal : literals) {
+            clause.push(literal);
           }
+          solver.addClause(clause);
         }
+
+        // ... has at most one value
+        add_at_most_one(&solver, literals, encoding);
       }
     }
 
     // Structural constraints: in each region...
-    for (const auto& region : SudokuConstants<size>::regions) {
+    for (const auto& region : constants.regions) {
       // ... each value...
-      for (const unsigned val : SudokuConstants<size>::values) {
+      for (unsigned val = 0; val != size; ++val) {
         // ... appears at most once
-        for (const auto& cell1 : region) {
-          for (const auto& cell2 : region) {
-            if (cell1 < cell2) {
-              solver.addClause(
-                ~Minisat::mkLit(has_value[cell1.first][cell1.second][val]),
-                ~Minisat::mkLit(has_value[cell2.first][cell2.second][val]));
-            }
+        std::vector<Minisat::Lit> literals;
+        for (const auto& [row, col] : region) {
+          if (variable(row, col, val) != Minisat::var_Undef) {
+            literals.push_back(Minisat::mkLit(variable(row, col, val)));
           }
         }
+        add_at_most_one(&solver, literals, encoding);
         // ... appears at least once
         // Not needed because these clauses are implied by the cell constraints
       }
     }
   }
 
-  {
-    CHRONE("circumstantial constraints");
-    // Circumstantial constraints: inputs are honored
-    for (const auto& cell : sudoku.cells()) {
-      const auto [row, col] = cell.coordinates();
-      const auto value = cell.get();
-      if (value) {
-        solver.addClause(Minisat::mkLit(has_value[row][col][*value]));
+  std::optional<RuntimeSudoku> solve(RuntimeSudoku sudoku, const SatOptions& options) {
+    assert(sudoku.size() == size);
+
+    Minisat::vec<Minisat::Lit> assumptions;
+    {
+      CHRONE("circumstantial constraints");
+      // Circumstantial constraints: inputs are honored
+      for (unsigned row = 0; row != size; ++row) {
+        for (unsigned col = 0; col != size; ++col) {
+          const auto value = sudoku.get({row, col});
+          if (value && variable(row, col, *value) != Minisat::var_Undef) {
+            assumptions.push(Minisat::mkLit(variable(row, col, *value)));
+          }
+        }
+      }
+    }
+
+    Minisat::lbool solved = Minisat::l_Undef;
+    {
+      CHRONE("solve");
+      const Cancellation::Interruption interruption(options.cancellation, [this]() { solver.interrupt(); });
+      if (options.budget) {
+        solved = solve_within_budget(assumptions, options);
+      } else {
+        solved = solver.solveLimited(assumptions);
+      }
+    }
+    // Keep the formula usable for the next Sudokus, even if this one was interrupted
+    solver.clearInterrupt();
+
+    {
+      CHRONE("decode");
+      if (solved == Minisat::l_True) {
+        for (unsigned row = 0; row != size; ++row) {
+          for (unsigned col = 0; col != size; ++col) {
+            for (unsigned val = 0; val != size; ++val) {
+              if (
+                variable(row, col, val) != Minisat::var_Undef
+                && solver.model[variable(row, col, val)] == Minisat::l_True
+              ) {
+                sudoku.set({row, col}, val);
+              }
+            }
+          }
+        }
+        return sudoku;
+      } else {
+        return std::nullopt;
       }
     }
   }
 
-  Minisat::lbool solved = Minisat::l_False;
-  {
-    CHRONE("solve");
-    Minisat::vec<Minisat::Lit> dummy;
-    solved = solver.solveLimited(dummy);
+ private:
+  // Minisat stops by itself after the remaining conflicts, and a timer interrupts it at the deadline, so it solves
+  // in a single call, without restarting its restart sequence and learned clauses limit.
+  Minisat::lbool solve_within_budget(const Minisat::vec<Minisat::Lit>& assumptions, const SatOptions& options) {
+    // Started on first use in each thread, and kept for the next Sudokus
+    thread_local Timer timer;
+
+    while (true) {
+      const auto remaining_conflicts = options.budget->remaining_conflicts();
+      if (remaining_conflicts) {
+        solver.setConfBudget(*remaining_conflicts);
+      }
+      const auto& deadline = options.budget->get_deadline();
+      if (deadline) {
+        timer.arm(*deadline, [this]() { solver.interrupt(); });
+      }
+      const uint64_t conflicts_before = solver.conflicts;
+      const Minisat::lbool solved = solver.solveLimited(assumptions);
+      if (deadline) {
+        timer.disarm();
+      }
+      const bool cancelled = options.cancellation && options.cancellation->is_cancelled();
+      // Without a result, Minisat was cancelled, or ran out of conflicts or time, so charging them gives up
+      if (
+        solved != Minisat::l_Undef
+        || cancelled
+        || !options.budget->spend_conflicts(solver.conflicts - conflicts_before)
+      ) {
+        solver.budgetOff();
+        return solved;
+      }
+    }
   }
 
-  {
-    CHRONE("decode");
-    if (solved == Minisat::l_True) {
-      for (auto& cell : sudoku.cells()) {
-        const auto [row, col] = cell.coordinates();
-        for (const unsigned val : SudokuConstants<size>::values) {
-          if (solver.model[has_value[row][col][val]] == Minisat::l_True) {
-            cell.set(val);
+  std::vector<Minisat::Lit> cell_literals(const unsigned row, const unsigned col) const {
+    std::vector<Minisat::Lit> literals;
+    for (unsigned val = 0; val != size; ++val) {
+      if (variable(row, col, val) != Minisat::var_Undef) {
+        literals.push_back(Minisat::mkLit(variable(row, col, val)));
+      }
+    }
+    return literals;
+  }
+
+  Minisat::Var& variable(const unsigned row, const unsigned col, const unsigned val) {
+    return has_value[(row * size + col) * size + val];
+  }
+
+  Minisat::Var variable(const unsigned row, const unsigned col, const unsigned val) const {
+    return has_value[(row * size + col) * size + val];
+  }
+
+ private:
+  const unsigned size;
+  // Not a 'SimpSolver': its variable elimination would conflict with assumptions
+  Minisat::Solver solver;
+  // Indexed by '(row * size + col) * size + val'
+  std::vector<Minisat::Var> has_value;
+};
+
+SatCandidates all_candidates(const unsigned size) {
+  assert(size <= 64);
+  const uint64_t all_values = size == 64 ? ~uint64_t(0) : (uint64_t(1) << size) - 1;
+  return SatCandidates(size * size, all_values);
+}
+
+// Each value of a given is excluded from its peers, and the given's cell needs no variables.
+// Returns 'std::nullopt' if this leaves an unset cell without candidates, or if givens contradict each other.
+std::optional<SatCandidates> pre_eliminate(const RuntimeSudokuConstants& constants, const RuntimeSudoku& sudoku) {
+  CHRONE();
+
+  SatCandidates candidates = all_candidates(sudoku.size());
+
+  for (unsigned row = 0; row != sudoku.size(); ++row) {
+    for (unsigned col = 0; col != sudoku.size(); ++col) {
+      const auto value = sudoku.get({row, col});
+      if (value) {
+        const uint64_t bit = uint64_t(1) << *value;
+        if (!(candidates[row * sudoku.size() + col] & bit)) {
+          return std::nullopt;
+        }
+        for (const unsigned region : constants.regions_of[row * sudoku.size() + col]) {
+          for (const auto& [peer_row, peer_col] : constants.regions[region]) {
+            if (peer_row != row || peer_col != col) {
+              candidates[peer_row * sudoku.size() + peer_col] &= ~bit;
+            }
           }
         }
       }
-      return sudoku;
-    } else {
+    }
+  }
+
+  for (unsigned row = 0; row != sudoku.size(); ++row) {
+    for (unsigned col = 0; col != sudoku.size(); ++col) {
+      auto& cell_candidates = candidates[row * sudoku.size() + col];
+      if (sudoku.get({row, col})) {
+        cell_candidates = 0;
+      } else if (cell_candidates == 0) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  return candidates;
+}
+
+}  // namespace
+
+
+std::optional<RuntimeSudoku> solve_using_sat(RuntimeSudoku sudoku, const SatOptions& options) {
+  CHRONE();
+
+  const auto& constants = RuntimeSudokuConstants::get(sudoku.size());
+  if (options.pre_eliminate) {
+    const auto candidates = pre_eliminate(constants, sudoku);
+    if (!candidates) {
       return std::nullopt;
     }
+    return Formula(constants, *candidates, options.encoding).solve(sudoku, options);
+  } else {
+    // Built on first use in each thread, because Minisat solvers are not thread-safe
+    thread_local std::map<std::pair<unsigned, SatOptions::Encoding>, std::unique_ptr<Formula>> formulas;
+    auto& formula = formulas[{sudoku.size(), options.encoding}];
+    if (!formula) {
+      formula = std::make_unique<Formula>(constants, all_candidates(sudoku.size()), options.encoding);
+    }
+    return formula->solve(sudoku, options);
   }
 }
 
-template std::optional<Sudoku<ValueCell, 4>> solve_using_sat(Sudoku<ValueCell, 4>);
-template std::optional<Sudoku<ValueCell, 9>> solve_using_sat(Sudoku<ValueCell, 9>);
-template std::optional<Sudoku<ValueCell, 16>> solve_using_sat(Sudoku<ValueCell, 16>);
-template std::optional<Sudoku<ValueCell, 25>> solve_using_sat(Sudoku<ValueCell, 25>);
+std::optional<RuntimeSudoku> solve_using_sat(
+  const RuntimeSudoku& sudoku,
+  const SatCandidates& candidates,
+  const SatOptions& options
+) {
+  CHRONE();
+
+  return Formula(RuntimeSudokuConstants::get(sudoku.size()), candidates, options.encoding).solve(sudoku, options);
+}
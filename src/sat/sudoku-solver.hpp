@@ -3,12 +3,67 @@
 #ifndef SAT_SUDOKU_SOLVER_HPP_
 #define SAT_SUDOKU_SOLVER_HPP_
 
+#include <cstdint>
 #include <optional>
+#include <vector>
 
+#include "../parallel/cancellation.hpp"
+#include "../puzzle/budget.hpp"
+#include "../puzzle/runtime-sudoku.hpp"
 #include "../puzzle/sudoku.hpp"
 
 
+struct SatOptions {
+  // How "at most one of these n literals is true" is turned into clauses
+  enum class Encoding {
+    // One binary clause for each pair of literals: n * (n - 1) / 2 clauses
+    pairwise,
+    // Sinz's sequential counter: 3 * n clauses, n auxiliary variables
+    sequential_counter,
+    // Klieber and Kwon's commander encoding, with groups of 3 literals: about 3 * n clauses, n / 2 auxiliary variables
+    commander,
+    // Chen's product encoding: about 2 * n clauses, 2 * sqrt(n) auxiliary variables
+    product,
+  };
+
+  Encoding encoding = Encoding::pairwise;
+
+  // Build a formula for each Sudoku, with variables only for the values not already excluded by its givens,
+  // instead of reusing the same formula of the structural constraints for all Sudokus
+  bool pre_eliminate = false;
+
+  // When cancelled, Minisat is interrupted and the Sudoku is reported as not solved
+  Cancellation* cancellation = nullptr;
+
+  // Charged for Minisat's conflicts: when exhausted, SAT gives up
+  Budget* budget = nullptr;
+};
+
+// The values that can be in each cell: bit 'value' of 'candidates[row * size + col]'
+typedef std::vector<uint64_t> SatCandidates;
+
+// SAT gains nothing from a compile-time size: its work is in Minisat, so it's compiled once for all sizes
+std::optional<RuntimeSudoku> solve_using_sat(RuntimeSudoku, const SatOptions& = {});
+
+// Solves the Sudoku with a formula built for these candidates only. Cells without candidates get no variables,
+// so they must be set in the Sudoku. 'pre_eliminate' is ignored: this is already a formula for this Sudoku.
+std::optional<RuntimeSudoku> solve_using_sat(const RuntimeSudoku&, const SatCandidates&, const SatOptions& = {});
+
+template<unsigned size>
+std::optional<Sudoku<ValueCell, size>> solve_using_sat(
+  const Sudoku<ValueCell, size>& sudoku,
+  const SatOptions& options = {}
+) {
+  return to_sudoku<size>(solve_using_sat(RuntimeSudoku(sudoku), options));
+}
+
 template<unsigned size>
-std::optional<Sudoku<ValueCell, size>> solve_using_sat(Sudoku<ValueCell, size>);
+std::optional<Sudoku<ValueCell, size>> solve_using_sat(
+  const Sudoku<ValueCell, size>& sudoku,
+  const SatCandidates& candidates,
+  const SatOptions& options = {}
+) {
+  return to_sudoku<size>(solve_using_sat(RuntimeSudoku(sudoku), candidates, options));
+}
 
 #endif  // SAT_SUDOKU_SOLVER_HPP_